@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+"""
+Palette image converter for the XGLCD library for www.x-graph.be
+Copyright (c) 2019 DELCOMp bvba / UVee bvba
+2sd (a t) delcomp (d o t) com
+
+License:GNU General Public License v3.0
+
+Converts an image with at most 256 colors to a tIndexedImage for XGLCD::drawIndexed()
+The smallest depth (1, 2, 4 or 8 bits per pixel) that holds all colors is used.
+
+USE:
+    python3 xg_indexed.py icon.png -n icon -o icon.h        (any image Pillow can read)
+    python3 xg_indexed.py img_flower_icon.c                 (LittleVGL true color image array)
+
+Colors are compared after the conversion to RGB565, reduce the image to a palette first
+(for example in GIMP: Image / Mode / Indexed) if it has more colors.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+from xg_rle import load_image, load_lvgl
+
+
+def pack(w, h, pixels, palette, bits):
+    index = {c: i for i, c in enumerate(palette)}
+    out = bytearray()
+    for y in range(h):
+        acc, n = 0, 0
+        for x in range(w):
+            acc = (acc << bits) | index[pixels[y * w + x]]
+            n += bits
+            if n == 8:
+                out.append(acc)
+                acc, n = 0, 0
+        if n:                                               # lines start on a byte boundary
+            out.append(acc << (8 - n))
+    return bytes(out)
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Convert an image to an XGLCD palette image')
+    ap.add_argument('input', help='image file, or a LittleVGL .c image array')
+    ap.add_argument('-n', '--name', help='image name (default: input file name)')
+    ap.add_argument('-o', '--output', help='output file (default: stdout)')
+    args = ap.parse_args()
+
+    base = os.path.splitext(os.path.basename(args.input))[0]
+    name = args.name or re.sub(r'\W', '_', base)
+    if args.input.endswith('.c'):
+        w, h, pixels = load_lvgl(args.input)
+    else:
+        w, h, pixels = load_image(args.input)
+    palette = sorted(set(pixels))
+    if len(palette) > 256:
+        sys.exit('%s: %d colors, reduce the image to 256 colors first' % (args.input, len(palette)))
+    bits = next(b for b in (1, 2, 4, 8) if len(palette) <= (1 << b))
+    data = pack(w, h, pixels, palette, bits)
+
+    lines = ['// %s: %d x %d, %d colors, %d bits per pixel, %d bytes (%d as RGB565)'
+             % (base, w, h, len(palette), bits, len(data) + len(palette) * 2, w * h * 2),
+             'const uint16_t %s_palette[] = {' % name]
+    for i in range(0, len(palette), 8):
+        lines.append('    ' + ', '.join('0x%04x' % c for c in palette[i:i + 8]) + ',')
+    lines.append('};')
+    lines.append('const uint8_t %s_data[] = {' % name)
+    for i in range(0, len(data), 16):
+        lines.append('    ' + ', '.join('0x%02x' % b for b in data[i:i + 16]) + ',')
+    lines.append('};')
+    lines.append('const tIndexedImage %s = { %d, %d, %d, %d, %s_palette, %s_data };'
+                 % (name, w, h, bits, len(palette), name, name))
+    text = '\n'.join(lines) + '\n'
+    if args.output:
+        open(args.output, 'w').write(text)
+    else:
+        sys.stdout.write(text)
+    sys.stderr.write('%s: %d x %d, %d colors, %d -> %d bytes\n'
+                     % (args.input, w, h, len(palette), w * h * 2, len(data) + len(palette) * 2))
+
+
+if __name__ == '__main__':
+    main()
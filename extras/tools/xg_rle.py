@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+"""
+Run length encoded image converter for the XGLCD library for www.x-graph.be
+Copyright (c) 2019 DELCOMp bvba / UVee bvba
+2sd (a t) delcomp (d o t) com
+
+License:GNU General Public License v3.0
+
+Converts an image to a C array for XGLCD::drawRLE()
+
+USE:
+    python3 xg_rle.py benchmark_bg.c                        (LittleVGL true color image array)
+    python3 xg_rle.py logo.png -n logo -o logo_rle.h        (any image Pillow can read)
+
+FORMAT (see XGLCD::drawRLE):
+    'X','R', width and height (16 bit little endian), followed by packets:
+    0x00-0x7F: c+1 literal pixels follow
+    0x80-0xFE: one pixel follows, repeated (c & 0x7F)+1 times
+    0xFF: 16 bit little endian count and one pixel follow (long run)
+    Pixels are RGB565, high byte first. Runs continue on the next line.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+
+def rgb565(r, g, b):
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3)
+
+
+def load_lvgl(filename):
+    """Read the 16 bit (LV_COLOR_16_SWAP == 0) part of a LittleVGL image array"""
+    text = open(filename).read()
+    w = int(re.search(r'\.header\.w\s*=\s*(\d+)', text).group(1))
+    h = int(re.search(r'\.header\.h\s*=\s*(\d+)', text).group(1))
+    alpha = 'LV_IMG_CF_TRUE_COLOR_ALPHA' in text
+    m = re.search(r'#if LV_COLOR_DEPTH == 16 && LV_COLOR_16_SWAP == 0(.*?)#endif', text, re.S)
+    if m is None:
+        sys.exit('%s: no 16 bit color data found' % filename)
+    data = [int(v, 16) for v in re.findall(r'0x([0-9a-fA-F]{2})', m.group(1))]
+    step = 3 if alpha else 2                                # the alpha byte is dropped
+    pixels = [data[i] | (data[i + 1] << 8) for i in range(0, w * h * step, step)]
+    return w, h, pixels
+
+
+def load_image(filename):
+    from PIL import Image
+    img = Image.open(filename).convert('RGB')
+    w, h = img.size
+    return w, h, [rgb565(*p) for p in img.getdata()]
+
+
+def encode(w, h, pixels):
+    out = bytearray(b'XR')
+    out += bytes([w & 0xFF, w >> 8, h & 0xFF, h >> 8])
+    literal = []
+
+    def flush():
+        while literal:
+            chunk = literal[:128]
+            del literal[:128]
+            out.append(len(chunk) - 1)
+            for p in chunk:
+                out.extend((p >> 8, p & 0xFF))
+
+    i = 0
+    while i < len(pixels):
+        j = i + 1
+        while j < len(pixels) and pixels[j] == pixels[i] and j - i < 0xFFFF:
+            j += 1
+        n = j - i
+        if n >= 2:                                          # a run of 2 already saves a byte
+            flush()
+            if n <= 127:
+                out.append(0x80 | (n - 1))
+            else:
+                out += bytes([0xFF, n & 0xFF, n >> 8])
+            out += bytes([pixels[i] >> 8, pixels[i] & 0xFF])
+        else:
+            literal.append(pixels[i])
+        i = j
+    flush()
+    return bytes(out)
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Convert an image to an XGLCD run length encoded C array')
+    ap.add_argument('input', help='image file, or a LittleVGL .c image array')
+    ap.add_argument('-n', '--name', help='array name (default: input file name + _rle)')
+    ap.add_argument('-o', '--output', help='output file (default: stdout)')
+    args = ap.parse_args()
+
+    base = os.path.splitext(os.path.basename(args.input))[0]
+    name = args.name or re.sub(r'\W', '_', base) + '_rle'
+    if args.input.endswith('.c'):
+        w, h, pixels = load_lvgl(args.input)
+    else:
+        w, h, pixels = load_image(args.input)
+    data = encode(w, h, pixels)
+
+    lines = ['// %s: %d x %d, %d bytes (%d uncompressed), draw with tft.drawRLE(x, y, %s)'
+             % (base, w, h, len(data), w * h * 2, name),
+             'const uint8_t %s[] = {' % name]
+    for i in range(0, len(data), 16):
+        lines.append('    ' + ', '.join('0x%02x' % b for b in data[i:i + 16]) + ',')
+    lines.append('};')
+    text = '\n'.join(lines) + '\n'
+    if args.output:
+        open(args.output, 'w').write(text)
+    else:
+        sys.stdout.write(text)
+    sys.stderr.write('%s: %d x %d, %d -> %d bytes\n' % (args.input, w, h, w * h * 2, len(data)))
+
+
+if __name__ == '__main__':
+    main()
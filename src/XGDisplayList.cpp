@@ -0,0 +1,438 @@
+/*
+ Display lists for the XGLCD library for www.x-graph.be
+ Copyright (c) 2019 DELCOMp bvba / UVee bvba
+ 2sd (a t) delcomp (d o t) com
+
+ License:GNU General Public License v3.0
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "XGDisplayList.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define XG_DL_NONE                  0xFFFF                                      // no op position
+
+/******************************************************************************/
+/*!
+ Create a display list in a user supplied buffer
+ Parameters:
+ buffer: storage for the recorded ops
+ size: size of buffer in bytes
+ */
+/******************************************************************************/
+XGDisplayList::XGDisplayList(uint8_t *buffer, uint16_t size)
+{
+    _buf = buffer;
+    _size = size;
+    _owner = false;
+    clear();
+}
+
+/******************************************************************************/
+/*!
+ Create a display list, the buffer is allocated on the heap
+ Parameters:
+ size: size of the buffer in bytes
+ */
+/******************************************************************************/
+XGDisplayList::XGDisplayList(uint16_t size)
+{
+    _buf = (uint8_t *)malloc(size);
+    _size = (_buf != NULL) ? size : 0;
+    _owner = true;
+    clear();
+}
+
+XGDisplayList::~XGDisplayList(void)
+{
+    if (_owner) free(_buf);
+}
+
+/******************************************************************************/
+/*!
+ Remove all recorded ops
+ */
+/******************************************************************************/
+void XGDisplayList::clear(void)
+{
+    _len = 0;
+    _overflow = false;
+    _colorValid = false;
+}
+
+/******************************************************************************/
+/*!
+ Number of int16_t parameters that follow an opcode
+ */
+/******************************************************************************/
+uint8_t XGDisplayList::params(uint8_t op)
+{
+    switch (op & ~XG_DL_DELETED){
+        case XG_DL_COLOR:           return 1;
+        case XG_DL_PIXEL:           return 2;
+        case XG_DL_CIRCLE:
+        case XG_DL_FILLCIRCLE:      return 3;
+        case XG_DL_WINDOW:
+        case XG_DL_CLIP:
+        case XG_DL_LINE:
+        case XG_DL_RECT:
+        case XG_DL_FILLRECT:
+        case XG_DL_BITMAP:          return 4;
+        case XG_DL_RRECT:
+        case XG_DL_FILLRRECT:
+        case XG_DL_CURVE:
+        case XG_DL_FILLCURVE:       return 5;
+        case XG_DL_TRIANGLE:
+        case XG_DL_FILLTRIANGLE:
+        case XG_DL_TEXT:            return 6;
+        default:                    return 0;
+    }
+}
+
+/******************************************************************************/
+/*!
+ Size in bytes of the op at 'op', including the opcode and any trailing data
+ */
+/******************************************************************************/
+uint16_t XGDisplayList::opSize(const uint8_t *op)
+{
+    uint16_t s = 1 + (params(op[0]) * 2);
+
+    switch (op[0] & ~XG_DL_DELETED){
+        case XG_DL_TEXT:            return s + (uint16_t)get16(op + 11);        // + the characters
+        case XG_DL_BITMAP:          return s + sizeof(uint16_t *);              // + the image pointer
+        default:                    return s;
+    }
+}
+
+const uint16_t * XGDisplayList::getBitmap(const uint8_t *op)
+{
+    const uint16_t *image;
+    memcpy(&image, op + 9, sizeof(image));
+    return image;
+}
+
+/******************************************************************************/
+/*!
+ Recording, called by XGLCD while a list is attached with beginRecording()
+ Parameters:
+ op: one of the XG_DL_ opcodes
+ p: parameters
+ n: number of parameters
+ color: a color op is inserted first when this differs from the last color
+ NOTE:
+ When the buffer is full overflow() is set and all further ops are dropped,
+ the list then stops at the last complete op
+ */
+/******************************************************************************/
+void XGDisplayList::add(uint8_t op, const int16_t *p, uint8_t n, uint16_t color)
+{
+    bool newColor = !_colorValid || color != _color;
+
+    if (!_reserve((newColor ? 3 : 0) + 1 + (n * 2))) return;
+    if (newColor) {
+        _buf[_len++] = XG_DL_COLOR;
+        _put16(color);
+        _color = color;
+        _colorValid = true;
+    }
+    add(op, p, n);
+}
+
+void XGDisplayList::add(uint8_t op, const int16_t *p, uint8_t n)
+{
+    uint8_t i;
+
+    if (!_reserve(1 + (n * 2))) return;
+    _buf[_len++] = op;
+    for (i = 0; i < n; i++) _put16(p[i]);
+}
+
+void XGDisplayList::addText(const int16_t *p, const char *text, uint16_t len)
+{
+    if (!_reserve(1 + 12 + len)) return;
+    add(XG_DL_TEXT, p, 6);
+    memcpy(_buf + _len, text, len);
+    _len += len;
+}
+
+void XGDisplayList::addBitmap(const int16_t *p, const uint16_t *image)
+{
+    if (!_reserve(1 + 8 + sizeof(image))) return;
+    add(XG_DL_BITMAP, p, 4);
+    memcpy(_buf + _len, &image, sizeof(image));
+    _len += sizeof(image);
+}
+
+bool XGDisplayList::_reserve(uint16_t bytes)
+{
+    if (_overflow || (uint32_t)_len + bytes > _size) {
+        _overflow = true;
+        return false;
+    }
+    return true;
+}
+
+void XGDisplayList::_put16(int16_t v)
+{
+    _set16(_buf + _len, v);
+    _len += 2;
+}
+
+void XGDisplayList::_set16(uint8_t *p, int16_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+}
+
+/******************************************************************************/
+/*!
+ Bounding box of the pixels an op can touch
+ Returns false for ops without a known area (text, fillWindow, state ops)
+ [private]
+ */
+/******************************************************************************/
+bool XGDisplayList::_bounds(const uint8_t *op, int16_t &x1, int16_t &y1, int16_t &x2, int16_t &y2)
+{
+    int16_t p[6];
+    uint8_t i, n = params(op[0]);
+
+    for (i = 0; i < n; i++) p[i] = get16(op + 1 + (i * 2));
+    switch (op[0] & ~XG_DL_DELETED){
+        case XG_DL_PIXEL:
+            x1 = x2 = p[0]; y1 = y2 = p[1];
+            return true;
+        case XG_DL_CIRCLE:
+        case XG_DL_FILLCIRCLE:
+            if (p[2] < 1) p[2] = 1;
+            x1 = p[0] - p[2]; x2 = p[0] + p[2];
+            y1 = p[1] - p[2]; y2 = p[1] + p[2];
+            return true;
+        case XG_DL_CURVE:
+        case XG_DL_FILLCURVE:                                                   // whole ellipse, also for curve parts
+            x1 = p[0] - p[2]; x2 = p[0] + p[2];
+            y1 = p[1] - p[3]; y2 = p[1] + p[3];
+            return true;
+        case XG_DL_LINE:
+        case XG_DL_RECT:
+        case XG_DL_FILLRECT:
+        case XG_DL_RRECT:
+        case XG_DL_FILLRRECT:
+        case XG_DL_BITMAP:
+            x1 = p[0] < p[2] ? p[0] : p[2]; x2 = p[0] < p[2] ? p[2] : p[0];
+            y1 = p[1] < p[3] ? p[1] : p[3]; y2 = p[1] < p[3] ? p[3] : p[1];
+            return true;
+        case XG_DL_TRIANGLE:
+        case XG_DL_FILLTRIANGLE:
+            x1 = x2 = p[0]; y1 = y2 = p[1];
+            for (i = 2; i < 6; i += 2){
+                if (p[i] < x1) x1 = p[i];
+                if (p[i] > x2) x2 = p[i];
+                if (p[i+1] < y1) y1 = p[i+1];
+                if (p[i+1] > y2) y2 = p[i+1];
+            }
+            return true;
+        default:
+            return false;
+    }
+}
+
+/******************************************************************************/
+/*!
+ Optimise the recorded list, drawing the optimised list gives the same
+ screen content as drawing the original one:
+ - ops completely covered by a later filled rectangle are removed
+ - color, window and clip ops that do not change anything are removed
+ - touching filled rectangles with the same color that form a rectangle
+   together are merged into one
+ */
+/******************************************************************************/
+void XGDisplayList::optimize(void)
+{
+    if (_overflow) return;                                                      // incomplete list, leave as is
+    _removeHidden();
+    _compact();
+}
+
+/******************************************************************************/
+/*!
+ Mark every op whose area is covered by a later filled rectangle as deleted
+ A window or clip op between the two ops clips the rectangle, so the covered
+ op must then lie inside the part of the rectangle that is inside that window
+ and clip rectangle. The clip rectangle of the caller of drawList limits all
+ ops alike, so the clip is known from the start of the list.
+ [private]
+ */
+/******************************************************************************/
+void XGDisplayList::_removeHidden(void)
+{
+    uint16_t a, b;
+    uint16_t wPos = 0;                                                          // position of the last window or clip change
+    bool wKnown = false;
+    int16_t wx1 = 0, wy1 = 0, wx2 = 0, wy2 = 0;
+    int16_t kx1 = -32768, ky1 = -32768, kx2 = 32767, ky2 = 32767;               // recorded clip rectangle
+    int16_t bx1, by1, bx2, by2;
+    int16_t cx1, cy1, cx2, cy2;
+    int16_t x1, y1, x2, y2;
+
+    for (b = 0; b < _len; b += opSize(_buf + b)){
+        switch (_buf[b]){
+            case XG_DL_WINDOW:
+                wx1 = get16(_buf + b + 1); wx2 = get16(_buf + b + 3);
+                wy1 = get16(_buf + b + 5); wy2 = get16(_buf + b + 7);
+                wKnown = true;
+                wPos = b;
+                break;
+            case XG_DL_WINDOWFULL:
+                wx1 = wy1 = -32768; wx2 = wy2 = 32767;
+                wKnown = true;
+                wPos = b;
+                break;
+            case XG_DL_CLIP:
+                kx1 = get16(_buf + b + 1); ky1 = get16(_buf + b + 3);
+                kx2 = get16(_buf + b + 5); ky2 = get16(_buf + b + 7);
+                wPos = b;
+                break;
+            case XG_DL_CLIPOFF:
+                kx1 = ky1 = -32768; kx2 = ky2 = 32767;
+                wPos = b;
+                break;
+        }
+        if (_buf[b] != XG_DL_FILLRECT) continue;
+
+        _bounds(_buf + b, bx1, by1, bx2, by2);
+        cx1 = bx1 > wx1 ? bx1 : wx1; cx2 = bx2 < wx2 ? bx2 : wx2;
+        cy1 = by1 > wy1 ? by1 : wy1; cy2 = by2 < wy2 ? by2 : wy2;
+        if (!wKnown){                                                           // the window of the caller, only the clip is known
+            cx1 = bx1; cx2 = bx2;
+            cy1 = by1; cy2 = by2;
+        }
+        if (kx1 > cx1) cx1 = kx1;
+        if (kx2 < cx2) cx2 = kx2;
+        if (ky1 > cy1) cy1 = ky1;
+        if (ky2 < cy2) cy2 = ky2;
+        for (a = 0; a < b; a += opSize(_buf + a)){
+            if (_buf[a] & XG_DL_DELETED) continue;
+            if (_buf[a] == XG_DL_BITMAP) continue;                              // keep, drawn unclipped by the active window
+            if (!_bounds(_buf + a, x1, y1, x2, y2)) continue;
+            if (a >= wPos){                                                     // same window and clip as the rectangle
+                if (x1 >= bx1 && x2 <= bx2 && y1 >= by1 && y2 <= by2) _buf[a] |= XG_DL_DELETED;
+            } else {
+                if (x1 >= cx1 && x2 <= cx2 && y1 >= cy1 && y2 <= cy2) _buf[a] |= XG_DL_DELETED;
+            }
+        }
+    }
+}
+
+/******************************************************************************/
+/*!
+ Rewrite the list in place without deleted ops, redundant color, window and
+ clip ops and with touching filled rectangles of the same color merged
+ Color, window and clip ops are held back until an op that needs them is
+ found, the list never grows so the output can not overtake the input.
+ A final clip op is dropped, drawList restores the clip rectangle.
+ [private]
+ */
+/******************************************************************************/
+void XGDisplayList::_compact(void)
+{
+    uint16_t i, o = 0, s;
+    uint16_t lastFill = XG_DL_NONE;                                             // output position of a directly preceding fill
+    uint8_t op;
+    int16_t color = 0, outColor = 0;
+    bool colorPend = false, outColorValid = false;
+    uint8_t winOp = 0, outWinOp = 0;                                            // pending / last emitted window op
+    int16_t win[4], outWin[4];
+    uint8_t clipOp = 0, outClipOp = XG_DL_CLIPOFF;                              // pending / last emitted clip op, a list starts with the clip of the caller
+    int16_t clip[4], outClip[4];
+    int16_t ax1, ay1, ax2, ay2, bx1, by1, bx2, by2;
+
+    for (i = 0; i < _len; i += s){
+        op = _buf[i];
+        s = opSize(_buf + i);
+        if (op & XG_DL_DELETED) continue;
+        if (op == XG_DL_COLOR){
+            color = get16(_buf + i + 1);
+            colorPend = true;
+            continue;
+        }
+        if (op == XG_DL_WINDOW || op == XG_DL_WINDOWFULL){
+            winOp = op;
+            if (op == XG_DL_WINDOW) for (uint8_t k = 0; k < 4; k++) win[k] = get16(_buf + i + 1 + (k * 2));
+            continue;
+        }
+        if (op == XG_DL_CLIP || op == XG_DL_CLIPOFF){
+            clipOp = op;
+            if (op == XG_DL_CLIP) for (uint8_t k = 0; k < 4; k++) clip[k] = get16(_buf + i + 1 + (k * 2));
+            continue;
+        }
+
+        if (winOp){                                                             // window change needed?
+            if (winOp != outWinOp || (winOp == XG_DL_WINDOW && memcmp(win, outWin, sizeof(win)) != 0)){
+                _buf[o++] = winOp;
+                if (winOp == XG_DL_WINDOW) for (uint8_t k = 0; k < 4; k++){ _set16(_buf + o, win[k]); o += 2; }
+                outWinOp = winOp;
+                memcpy(outWin, win, sizeof(win));
+                lastFill = XG_DL_NONE;
+            }
+            winOp = 0;
+        }
+        if (clipOp){                                                            // clip change needed?
+            if (clipOp != outClipOp || (clipOp == XG_DL_CLIP && memcmp(clip, outClip, sizeof(clip)) != 0)){
+                _buf[o++] = clipOp;
+                if (clipOp == XG_DL_CLIP) for (uint8_t k = 0; k < 4; k++){ _set16(_buf + o, clip[k]); o += 2; }
+                outClipOp = clipOp;
+                memcpy(outClip, clip, sizeof(clip));
+                lastFill = XG_DL_NONE;
+            }
+            clipOp = 0;
+        }
+        if (op != XG_DL_TEXT && op != XG_DL_BITMAP && colorPend && (!outColorValid || color != outColor)){
+            _buf[o++] = XG_DL_COLOR;                                            // color change needed
+            _set16(_buf + o, color); o += 2;
+            outColor = color;
+            outColorValid = true;
+            lastFill = XG_DL_NONE;
+        }
+
+        if (op == XG_DL_FILLRECT && lastFill != XG_DL_NONE){                    // try to merge with the previous fill
+            _bounds(_buf + lastFill, ax1, ay1, ax2, ay2);
+            _bounds(_buf + i, bx1, by1, bx2, by2);
+            if (bx1 >= ax1 && bx2 <= ax2 && by1 >= ay1 && by2 <= ay2){
+                continue;                                                       // already filled
+            } else if (ax1 == bx1 && ax2 == bx2 && by1 <= ay2 + 1 && by2 >= ay1 - 1){
+                _set16(_buf + lastFill + 1, ax1); _set16(_buf + lastFill + 3, by1 < ay1 ? by1 : ay1);
+                _set16(_buf + lastFill + 5, ax2); _set16(_buf + lastFill + 7, by2 > ay2 ? by2 : ay2);
+                continue;
+            } else if (ay1 == by1 && ay2 == by2 && bx1 <= ax2 + 1 && bx2 >= ax1 - 1){
+                _set16(_buf + lastFill + 1, bx1 < ax1 ? bx1 : ax1); _set16(_buf + lastFill + 3, ay1);
+                _set16(_buf + lastFill + 5, bx2 > ax2 ? bx2 : ax2); _set16(_buf + lastFill + 7, ay2);
+                continue;
+            }
+        }
+
+        memmove(_buf + o, _buf + i, s);
+        lastFill = (op == XG_DL_FILLRECT) ? o : XG_DL_NONE;
+        o += s;
+    }
+
+    if (winOp && (winOp != outWinOp || (winOp == XG_DL_WINDOW && memcmp(win, outWin, sizeof(win)) != 0))){
+        _buf[o++] = winOp;                                                      // keep a final window change, it is visible after replay
+        if (winOp == XG_DL_WINDOW) for (uint8_t k = 0; k < 4; k++){ _set16(_buf + o, win[k]); o += 2; }
+    }
+    _len = o;
+    _colorValid = false;                                                        // in case more ops are recorded
+}
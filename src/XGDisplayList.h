@@ -0,0 +1,130 @@
+/*
+ Display lists for the XGLCD library for www.x-graph.be
+ Records XGLCD drawing calls into a compact byte coded buffer that can be
+ optimised and replayed with one call
+ Copyright (c) 2019 DELCOMp bvba / UVee bvba
+ 2sd (a t) delcomp (d o t) com
+
+ License:GNU General Public License v3.0
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ USE:
+    uint8_t chromeBuf[2048];
+    XGDisplayList chrome(chromeBuf, sizeof(chromeBuf));
+
+    tft.beginRecording(&chrome);                // everything is drawn AND recorded
+    tft.clearScreen(COLOR_BLACK);
+    tft.drawMesh(0, 0, 800, 480, 20, COLOR_DARKGREY);
+    tft.roundGaugeTicker(200, 240, 150, 150, 390, 1.3, COLOR_WHITE);
+    tft.endRecording();
+    chrome.optimize();
+
+    tft.drawList(chrome);                       // redraw the page chrome
+
+ NOTES:
+ - coordinates are recorded as passed to the drawing primitives (after CENTER is resolved),
+   replay with the same rotation
+ - text is recorded with its position, colors and characters, the font, scale and
+   transparency in effect at replay time are used
+ - bitmaps are recorded by pointer, the image must stay valid as long as the list is used
+ - clip rectangle changes (setClipRect, pushClipRect...) are recorded as the rectangle in
+   effect. At replay it is combined with the clip rectangle of the caller, which is
+   restored when drawList returns
+ - not recorded, these draw at record time only:
+   drawPixels, pushPixels, writePattern, showUserChar, layer, scroll and BTE functions
+   drawPixels8, drawBitmap8, blit
+   scaled and rotated drawBitmap, drawBitmapSmooth
+   drawRLE, drawIndexed, drawMono, drawBitmapKeyed
+*/
+
+#ifndef _XGDISPLAYLIST_H_
+#define _XGDISPLAYLIST_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Display list opcodes, followed by little endian int16_t parameters
+// bit 0 of the shape opcodes is the 'filled' flag
+#define XG_DL_COLOR                 0x01                                        // color
+#define XG_DL_WINDOW                0x02                                        // XL,XR,YT,YB
+#define XG_DL_WINDOWFULL            0x03                                        // -
+#define XG_DL_FILLWIN               0x04                                        // - (fillWindow with current color)
+#define XG_DL_CLIP                  0x05                                        // x1,y1,x2,y2 (clip rectangle in effect, empty when x1 > x2)
+#define XG_DL_CLIPOFF               0x06                                        // - (no clip rectangle)
+#define XG_DL_PIXEL                 0x10                                        // x,y
+#define XG_DL_LINE                  0x12                                        // x0,y0,x1,y1
+#define XG_DL_RECT                  0x14                                        // x1,y1,x2,y2
+#define XG_DL_FILLRECT              0x15
+#define XG_DL_RRECT                 0x16                                        // x1,y1,x2,y2,r
+#define XG_DL_FILLRRECT             0x17
+#define XG_DL_CIRCLE                0x18                                        // x,y,r
+#define XG_DL_FILLCIRCLE            0x19
+#define XG_DL_TRIANGLE              0x1A                                        // x0,y0,x1,y1,x2,y2
+#define XG_DL_FILLTRIANGLE          0x1B
+#define XG_DL_CURVE                 0x1C                                        // x,y,longAxis,shortAxis,curvePart (255 = ellipse)
+#define XG_DL_FILLCURVE             0x1D
+#define XG_DL_TEXT                  0x20                                        // x,y,fcolor,bcolor,flags,len,chars
+#define XG_DL_BITMAP                0x22                                        // x1,y1,x2,y2,uint16_t *image
+#define XG_DL_DELETED               0x80                                        // internal: op removed by optimize()
+
+// XG_DL_TEXT flags
+#define XG_DL_TEXT_ABSCENTER        0x01
+#define XG_DL_TEXT_RELCENTER        0x02
+#define XG_DL_TEXT_ALIGNX           0x04
+#define XG_DL_TEXT_ALIGNY           0x08
+
+class XGDisplayList {
+  public:
+    XGDisplayList(uint8_t *buffer, uint16_t size);
+    XGDisplayList(uint16_t size);
+    ~XGDisplayList(void);
+
+    void            clear(void);
+    void            optimize(void);
+    uint16_t        length(void) const { return _len; }
+    uint16_t        size(void) const { return _size; }
+    bool            overflow(void) const { return _overflow; }
+    const uint8_t * data(void) const { return _buf; }
+
+    // recording, called by XGLCD
+    void            add(uint8_t op, const int16_t *p, uint8_t n, uint16_t color);
+    void            add(uint8_t op, const int16_t *p, uint8_t n);
+    void            addText(const int16_t *p, const char *text, uint16_t len);
+    void            addBitmap(const int16_t *p, const uint16_t *image);
+
+    // decoding, used by XGLCD::drawList
+    static uint8_t  params(uint8_t op);
+    static uint16_t opSize(const uint8_t *op);
+    static int16_t  get16(const uint8_t *p) { return (int16_t)(p[0] | (p[1] << 8)); }
+    static const uint16_t * getBitmap(const uint8_t *op);
+
+  private:
+    uint8_t *       _buf;
+    uint16_t        _size;
+    uint16_t        _len;
+    bool            _owner;
+    bool            _overflow;
+    bool            _colorValid;                                                // _color holds the last recorded color
+    uint16_t        _color;
+
+    bool            _reserve(uint16_t bytes);
+    void            _put16(int16_t v);
+    static void     _set16(uint8_t *p, int16_t v);
+    static bool     _bounds(const uint8_t *op, int16_t &x1, int16_t &y1, int16_t &x2, int16_t &y2);
+    void            _removeHidden(void);
+    void            _compact(void);
+};
+
+#endif
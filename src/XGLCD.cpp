@@ -85,6 +85,12 @@ UTFT remarks:
 */
 /******************************************************************************/
 XGLCD::XGLCD(void) {
+    _dmaBusy = false;
+    _dmaCallback = NULL;
+    _dl = NULL;
+#if defined(XG_CPU_ESP32)
+    dmaIntr = NULL;
+#endif
 }
 
 /******************************************************************************/
@@ -93,6 +99,7 @@ XGLCD::XGLCD(void) {
 */
 /******************************************************************************/
 void XGLCD::begin(void) {
+    _XGP_SCOPE;
 	
     // Init global variables
     _rotation = 0;
@@ -128,6 +135,12 @@ void XGLCD::begin(void) {
     _color_bpp = 0;
     _lcdtype = 0;
     _backTransparent = false;
+    _regBurstLen = 0;
+    _useInt = false;
+    _pipeline = false;
+    _pendReg = 0;
+    _clipOn = false;
+    _clipDepth = 0;
 
 	// Start SPI initialization
     pinMode(XG_PIN_LCD_CS, OUTPUT);
@@ -135,6 +148,11 @@ void XGLCD::begin(void) {
     _spibegin();
     setSPI();
     _spisetSpeed(SPI_SPEED_SLOW);
+#if defined(XG_CPU_ESP32)
+    if (dmaIntr == NULL) esp_intr_alloc(ETS_SPI3_INTR_SOURCE, 0, _dmaDoneISR, this, &dmaIntr);   // Used by drawBitmapAsync only
+#elif defined(XG_CPU_MKR) && !defined(XG_MKR_NO_DMA)
+    _dmacInit();
+#endif
     
     // I/O lines initialization
     pinMode(XG_PIN_LCD_RESET, OUTPUT);
@@ -152,7 +170,7 @@ void XGLCD::begin(void) {
     
     // Fill shadow registers
     _DPCR_Reg = RA8875_DPCR_ONE_LAYER + RA8875_DPCR_HDIR_NORMAL + RA8875_DPCR_VDIR_NORMAL;
-    _MWCR0_Reg = RA8875_MWCR0_GFXMODE + RA8875_MWCR0_NO_CURSOR + RA8875_MWCR0_CURSOR_NORMAL + RA8875_MWCR0_MEMWRDIR_LT + RA8875_MWCR0_MEMWR_CUR_INC + RA8875_MWCR0_MEMRD_NO_INC;
+    _MWCR0_Reg = RA8875_MWCR0_GFXMODE + RA8875_MWCR0_NO_CURSOR + RA8875_MWCR0_CURSOR_NORMAL + RA8875_MWCR0_MEMWRDIR_LT + RA8875_MWCR0_MEMWR_CUR_INC + RA8875_MWCR0_MEMRD_CUR_INC;
     _FNCR0_Reg = RA8875_FNCR0_CGROM + RA8875_FNCR0_INTERNAL_CGROM + RA8857_FNCR0_8859_1;
     _FNCR1_Reg = RA8875_FNCR1_ALIGNMENT_OFF + RA8875_FNCR1_TRANSPARENT_OFF + RA8875_FNCR1_NORMAL + RA8875_FNCR1_SCALE_HOR_1 + RA8875_FNCR1_SCALE_VER_1;
     _FWTSET_Reg = RA8875_FWTSET_16X16;
@@ -165,6 +183,7 @@ void XGLCD::begin(void) {
     delay(20);
     _writeData(RA8875_PWRR_NORMAL);
     delay(200);
+    _invalidateShadow();
     // Set slow clock speed with default pixclk
     _setSysClock(0x07, RA8875_PLLC2_DIV8, RA8875_PCSR_PDATL | RA8875_PCSR_2CLK);
 
@@ -349,6 +368,7 @@ void XGLCD::_setSysClock(uint8_t pll1,uint8_t pll2,uint8_t pixclk)
 /******************************************************************************/
 void XGLCD::displayOn(boolean on)
 {
+    _XGP_SCOPE;
     on == true ? _writeRegister(RA8875_PWRR, RA8875_PWRR_NORMAL | RA8875_PWRR_DISPON) : _writeRegister(RA8875_PWRR, RA8875_PWRR_NORMAL | RA8875_PWRR_DISPOFF);
 }
 
@@ -368,6 +388,8 @@ void XGLCD::displayOn(boolean on)
 // This is only required if other devices use the same SPI bus (for example the SDCard)
 
 void XGLCD::setSPI(void) {
+    _XGP_SCOPE;
+    if (_dmaBusy) waitIdle();
     _spisetDataMode(SPI_MODE_LCD);
     _spisetBitOrder(MSBFIRST);
     _spisetSpeed(SPI_SPEED_WRITE);
@@ -389,17 +411,203 @@ internals of the RA8875.
 	return true when register has done the job, otherwise false.
 */
 /******************************************************************************/
-boolean XGLCD::_waitPoll(uint8_t regname, uint8_t waitflag)
+// The register is selected once and the bus stays at read speed during the
+// wait, so every iteration is a single data read cycle.
+// confirm: number of consecutive 'done' reads needed (circles need 3)
+boolean XGLCD::_waitPoll(uint8_t regname, uint8_t waitflag, uint8_t confirm)
 {
 	uint8_t temp;
+	uint8_t done = 0;
+	boolean result = false;
 	unsigned long timeout = millis();
 	
+	writeCommand(regname);
+	_spisetSpeed(SPI_SPEED_READ);
+	while (1) {
+		temp = _readDataFast(false);
+		_XGP_POLL;
+		if (!(temp & waitflag)) {
+			if (++done >= confirm) {result = true; break;}
+		} else {
+			done = 0;
+		}
+		if ((millis() - timeout) > 20) break;                                   //emergency exit! Should never occur.
+	}
+	_spisetSpeed(SPI_SPEED_WRITE);
+	return result;
+}
+
+static volatile bool _xgIntFlag = false;                                        // Set on the falling edge of the INT pin
+
+/******************************************************************************/
+/*!
+	INT pin interrupt routine (useInterrupt() mode)
+*/
+/******************************************************************************/
+#if defined(XG_CPU_ESP32)
+static void IRAM_ATTR _xgIntISR(void)
+#else
+static void _xgIntISR(void)
+#endif
+{
+	_xgIntFlag = true;
+}
+
+/******************************************************************************/
+/*!
+	Wait for a RA8875 interrupt (useInterrupt() mode) on the INT pin
+	The CPU idles until _xgIntISR() flags the interrupt. When it does not
+	come in time (the timeout grows with the BTE size) this call polls the
+	status instead, the source stays enabled for the next waits.
+	With other interrupt sources enabled in INTC1 (touch, key scan, DMA) the
+	edge can be theirs: INTC2 is checked and the wait goes on if it is.
+	Parameters:
+	src: RA8875_INTCx_BTE or RA8875_INTCx_FONT
+	Returns false if interrupts are not used, the caller must then poll.
+*/
+/******************************************************************************/
+bool XGLCD::_waitInt(uint8_t src)
+{
+	unsigned long start = millis();
+	unsigned long timeout = 10;
+	bool shared = _INTC1_Reg & ~(RA8875_INTCx_BTE | RA8875_INTCx_FONT);        // Foreign sources on the same pin
+	
+	if (!_useInt || !(_INTC1_Reg & src)) return false;
+	if (src == RA8875_INTCx_BTE) {                                              // about 1ms per 8k pixels, a full screen move takes tens of ms
+		timeout += ((uint32_t)(_regShadow[RA8875_BEWR0] | (_regShadow[RA8875_BEWR1] << 8)) *
+			(_regShadow[RA8875_BEHR0] | (_regShadow[RA8875_BEHR1] << 8))) >> 13;
+	}
 	while (1) {
-		temp = _readRegister(regname);
-		if (!(temp & waitflag)) return true;
-		if ((millis() - timeout) > 20) return false;                            //emergency exit! Should never occur.
-	}  
-	return false;
+		_XGP_POLL;
+		if (_xgIntFlag) {
+			_xgIntFlag = false;
+			if (!shared || (_readRegister(RA8875_INTC2) & src)) break;          // Not ours: wait on
+		}
+#ifdef _cpuIdle
+		_cpuIdle();
+#endif
+		if ((millis() - start) > timeout) {                                     // Poll this time, INT is cleared below once done
+			_waitBusy(src == RA8875_INTCx_BTE ? 0x40 : 0x80);
+			break;
+		}
+	}
+	_writeRegister(RA8875_INTC2, RA8875_INTCx_BTE | RA8875_INTCx_FONT);         // Write 1 to clear, both: a pending one holds INT low
+	return true;
+}
+
+/******************************************************************************/
+/*!
+	Wait for a hardware command (draw engine or BTE) to finish, or only
+	remember it in pipelined mode (see usePipeline)
+	Parameters:
+	r: register to poll (RA8875_BECR0 = BTE, uses the interrupt if enabled)
+	f: busy flag
+	confirm: see _waitPoll
+*/
+/******************************************************************************/
+void XGLCD::_waitEngine(uint8_t r, uint8_t f, uint8_t confirm)
+{
+	if (_pipeline) {
+		_pendReg = r;
+		_pendFlag = f;
+		_pendConfirm = confirm;
+		return;
+	}
+	if (r == RA8875_BECR0) {
+		if (!_waitInt(RA8875_INTCx_BTE)) _waitBusy(f);
+	} else {
+		_waitPoll(r, f, confirm);
+	}
+}
+
+/******************************************************************************/
+/*!
+	Wait for the hardware command in flight (pipelined mode)
+*/
+/******************************************************************************/
+void XGLCD::_syncEngine(void)
+{
+	uint8_t r = _pendReg;
+	
+	if (r == 0) return;
+	_pendReg = 0;                                                               // Clear first: the wait itself uses the bus
+	if (r == RA8875_BECR0) {
+		if (!_waitInt(RA8875_INTCx_BTE)) _waitBusy(_pendFlag);
+	} else {
+		_waitPoll(r, _pendFlag, _pendConfirm);
+	}
+}
+
+/******************************************************************************/
+/*!
+	Returns false for registers that can be accessed while the draw engine
+	or BTE is running (they do not touch the draw registers, colors,
+	windows, cursors or display memory)
+	Parameters:
+	reg: the register
+*/
+/******************************************************************************/
+bool XGLCD::_regConflicts(const uint8_t reg)
+{
+	if (reg == RA8875_GPI || reg == RA8875_GPO || reg == RA8875_GPIOX) return false;
+	if (reg >= RA8875_HOFS0 && reg <= RA8875_VOFS1) return false;               // Scroll offset
+	if (reg >= RA8875_HSSW0 && reg <= RA8875_VESW0+1) return false;             // Scroll window
+	if (reg >= RA8875_TPCR0 && reg <= RA8875_TPXYL) return false;               // Touch panel
+	if (reg >= RA8875_GCHP0 && reg <= RA8875_GCC1) return false;                // Graphic cursor position/colors
+	if (reg >= RA8875_P1CR && reg <= RA8875_P2DCR) return false;                // PWM
+	if (reg >= RA8875_KSCR1 && reg <= RA8875_KSDR2) return false;               // Key scan
+	if (reg == RA8875_INTC1 || reg == RA8875_INTC2) return false;
+	return true;
+}
+
+/******************************************************************************/
+/*!
+	Pipelined mode: hardware accelerated commands (lines, rects, circles,
+	triangles, ellipses, BTE moves) return as soon as they are started.
+	The library only waits when a next command uses a register that the
+	running command depends on (draw registers, colors, windows, memory
+	cursors, BTE) or reads display memory. MCU work in between runs in
+	parallel with the RA8875.
+	Parameters:
+	on: true (pipelined), false (every command waits until done)
+*/
+/******************************************************************************/
+void XGLCD::usePipeline(boolean on)
+{
+    _XGP_SCOPE;
+	if (!on) _syncEngine();
+	_pipeline = on;
+}
+
+/******************************************************************************/
+/*!
+	Use the RA8875 INT pin to wait for BTE and font write completion
+	instead of polling the status over the (slow) SPI read clock.
+	Polling is still used for the geometric draw engine (no interrupt)
+	and when the interrupt does not arrive.
+	Parameters:
+	on: true (use interrupt), false (poll)
+	NOTE:
+	The INT pin is XG_PIN_TP_IRQ, the same pin as the touch interrupt.
+	When the touch (or key scan) interrupt is enabled in INTC1 as well,
+	every wait reads INTC2 to make sure the interrupt is a BTE or font one.
+*/
+/******************************************************************************/
+void XGLCD::useInterrupt(boolean on)
+{
+    _XGP_SCOPE;
+	_useInt = on;
+	if (on) {
+		pinMode(XG_PIN_TP_IRQ, INPUT_PULLUP);
+		_INTC1_Reg |= RA8875_INTCx_BTE | RA8875_INTCx_FONT;
+	} else {
+		_INTC1_Reg &= ~(RA8875_INTCx_BTE | RA8875_INTCx_FONT);
+		detachInterrupt(digitalPinToInterrupt(XG_PIN_TP_IRQ));
+	}
+	_writeRegister(RA8875_INTC1, _INTC1_Reg);
+	_writeRegister(RA8875_INTC2, RA8875_INTCx_BTE | RA8875_INTCx_FONT);         // Clear pending interrupts
+	_xgIntFlag = false;
+	if (on) attachInterrupt(digitalPinToInterrupt(XG_PIN_TP_IRQ), _xgIntISR, FALLING);
 }
 
 /******************************************************************************/
@@ -434,10 +642,14 @@ void XGLCD::_waitBusy(uint8_t res)
 	uint8_t temp; 	
 	unsigned long start = millis();
     
+	if (_dmaBusy) waitIdle();
+	_spisetSpeed(SPI_SPEED_READ);                                               // Once for the whole wait
 	do {
-		temp = readStatus();
-        if ((millis() - start) > 10) return;
+		temp = _readDataFast(true);
+		_XGP_POLL;
+        if ((millis() - start) > 10) break;
     } while ((temp & res) == res);
+	_spisetSpeed(SPI_SPEED_WRITE);
 }
 
 /******************************************************************************/
@@ -446,10 +658,12 @@ void XGLCD::_waitBusy(uint8_t res)
  */
 /******************************************************************************/
 void XGLCD::softReset(void) {
+    _XGP_SCOPE;
     writeCommand(RA8875_PWRR);
     _writeData(RA8875_PWRR_SOFTRESET);
     _writeData(RA8875_PWRR_NORMAL);
     delay(1);
+    _invalidateShadow();
 }
 
 /******************************************************************************/
@@ -460,6 +674,7 @@ void XGLCD::softReset(void) {
 /******************************************************************************/
 void XGLCD::sleep(boolean sleep)
 {
+    _XGP_SCOPE;
     if (_sleep != sleep){                                                       // only when needed
         _sleep = sleep;
         if (_sleep == true){
@@ -497,6 +712,7 @@ void XGLCD::sleep(boolean sleep)
  */
 /******************************************************************************/
 void XGLCD::GPIOX(boolean on) {
+    _XGP_SCOPE;
     if (on)
         _writeRegister(RA8875_GPIOX, 1);
     else
@@ -527,6 +743,8 @@ Here you will also find functions to rotate the display.
 /******************************************************************************/
 void XGLCD::setActiveWindow(void)
 {
+    _XGP_SCOPE;
+    if (_dl) _dl->add(XG_DL_WINDOWFULL, NULL, 0);
     _activeWindowXL = 0; _activeWindowXR = LCD_WIDTH;
     _activeWindowYT = 0; _activeWindowYB = LCD_HEIGHT;
     if (_portrait){swapvals(_activeWindowXL,_activeWindowYT); swapvals(_activeWindowXR,_activeWindowYB);}
@@ -545,6 +763,8 @@ void XGLCD::setActiveWindow(void)
 /******************************************************************************/
 void XGLCD::setActiveWindow(int16_t XL,int16_t XR ,int16_t YT ,int16_t YB)
 {
+    _XGP_SCOPE;
+    if (_dl) { const int16_t p[] = {XL,XR,YT,YB}; _dl->add(XG_DL_WINDOW, p, 4); }
     if (_portrait) {swapvals(XL,YT); swapvals(XR,YB);}
     
     if (XR >= LCD_WIDTH) XR = LCD_WIDTH;
@@ -565,27 +785,28 @@ void XGLCD::_updateActiveWindow(bool full)
 {
     if (full){
         // X
-        _writeRegister(RA8875_HSAW0,    0x00);
-        _writeRegister(RA8875_HSAW0 + 1,0x00);
-        _writeRegister(RA8875_HEAW0,    (LCD_WIDTH) & 0xFF);
-        _writeRegister(RA8875_HEAW0 + 1,(LCD_WIDTH) >> 8);
+        _queueRegister(RA8875_HSAW0,    0x00);
+        _queueRegister(RA8875_HSAW0 + 1,0x00);
+        _queueRegister(RA8875_HEAW0,    (LCD_WIDTH) & 0xFF);
+        _queueRegister(RA8875_HEAW0 + 1,(LCD_WIDTH) >> 8);
         // Y
-        _writeRegister(RA8875_VSAW0,    0x00);
-        _writeRegister(RA8875_VSAW0 + 1,0x00);
-        _writeRegister(RA8875_VEAW0,    (LCD_HEIGHT) & 0xFF);
-        _writeRegister(RA8875_VEAW0 + 1,(LCD_HEIGHT) >> 8);
+        _queueRegister(RA8875_VSAW0,    0x00);
+        _queueRegister(RA8875_VSAW0 + 1,0x00);
+        _queueRegister(RA8875_VEAW0,    (LCD_HEIGHT) & 0xFF);
+        _queueRegister(RA8875_VEAW0 + 1,(LCD_HEIGHT) >> 8);
     } else {
         // X
-        _writeRegister(RA8875_HSAW0,    _activeWindowXL & 0xFF);
-        _writeRegister(RA8875_HSAW0 + 1,_activeWindowXL >> 8);
-        _writeRegister(RA8875_HEAW0,    _activeWindowXR & 0xFF);
-        _writeRegister(RA8875_HEAW0 + 1,_activeWindowXR >> 8);
+        _queueRegister(RA8875_HSAW0,    _activeWindowXL & 0xFF);
+        _queueRegister(RA8875_HSAW0 + 1,_activeWindowXL >> 8);
+        _queueRegister(RA8875_HEAW0,    _activeWindowXR & 0xFF);
+        _queueRegister(RA8875_HEAW0 + 1,_activeWindowXR >> 8);
         // Y
-        _writeRegister(RA8875_VSAW0,     _activeWindowYT & 0xFF);
-        _writeRegister(RA8875_VSAW0 + 1,_activeWindowYT >> 8);
-        _writeRegister(RA8875_VEAW0,    _activeWindowYB & 0xFF);
-        _writeRegister(RA8875_VEAW0 + 1,_activeWindowYB >> 8);
+        _queueRegister(RA8875_VSAW0,     _activeWindowYT & 0xFF);
+        _queueRegister(RA8875_VSAW0 + 1,_activeWindowYT >> 8);
+        _queueRegister(RA8875_VEAW0,    _activeWindowYB & 0xFF);
+        _queueRegister(RA8875_VEAW0 + 1,_activeWindowYB >> 8);
     }
+    _flushRegisters();
 }
 
 /******************************************************************************/
@@ -600,6 +821,7 @@ void XGLCD::_updateActiveWindow(bool full)
 /******************************************************************************/
 void XGLCD::getActiveWindow(int16_t &XL,int16_t &XR ,int16_t &YT ,int16_t &YB)//0.69b24
 {
+    _XGP_SCOPE;
     XL = _activeWindowXL; XR = _activeWindowXR;
     YT = _activeWindowYT; YB = _activeWindowYB;
 }
@@ -632,10 +854,11 @@ void XGLCD::getActiveWindow(int16_t &XL,int16_t &XR ,int16_t &YT ,int16_t &YB)//
 /******************************************************************************/
 void XGLCD::clearMemory(bool stop)
 {
+    _XGP_SCOPE;
     uint8_t temp;
     temp = _readRegister(RA8875_MCLR);
     stop == true ? temp &= ~RA8875_MCLR_START : temp |= RA8875_MCLR_START;
-    _writeData(temp);
+    _writeRegister(RA8875_MCLR, temp);
     if (!stop) _waitBusy(0x80);
 }
 
@@ -649,10 +872,11 @@ void XGLCD::clearMemory(bool stop)
 /******************************************************************************/
 void XGLCD::clearActiveWindow(bool full)
 {
+    _XGP_SCOPE;
     uint8_t temp;
     temp = _readRegister(RA8875_MCLR);
     full == true ? temp &= ~RA8875_MCLR_ACTIVE : temp |= RA8875_MCLR_ACTIVE;
-    _writeData(temp);
+    _writeRegister(RA8875_MCLR, temp);
 }
 
 /******************************************************************************/
@@ -666,6 +890,7 @@ void XGLCD::clearActiveWindow(bool full)
 /******************************************************************************/
 uint16_t XGLCD::width(bool absolute) const
 { 
+    _XGP_SCOPE;
 	if (absolute) return LCD_WIDTH;
 	return _width; 
 }
@@ -681,6 +906,7 @@ uint16_t XGLCD::width(bool absolute) const
 /******************************************************************************/
 uint16_t XGLCD::height(bool absolute) const
 { 
+    _XGP_SCOPE;
 	if (absolute) return LCD_HEIGHT;
 	return _height; 
 }
@@ -713,6 +939,7 @@ void XGLCD::_scanDirection(boolean invertH,boolean invertV)
 /******************************************************************************/
 void XGLCD::setRotation(uint8_t rotation)//0.69b32 - less code
 {
+    _XGP_SCOPE;
 	_rotation = rotation % 4;                                                   //limit to the range 0-3
 	switch (_rotation) {
 	case 0:
@@ -751,6 +978,10 @@ void XGLCD::setRotation(uint8_t rotation)//0.69b32 - less code
     
     if (_portrait) _FNCR1_Reg |= RA8875_FNCR1_90DEGREES; else _FNCR1_Reg &= ~RA8875_FNCR1_90DEGREES;
     _writeRegister(RA8875_FNCR1,_FNCR1_Reg);                                    // Rotates fonts 90 degrees (for build-in fonts that is)
+    _MWCR0_Reg &= ~RA8875_MWCR0_MEMWRDIR_MASK;                                  // Pixel streams follow the rotated x axis: top-down in portrait mode
+    _MWCR0_Reg |= _portrait ? RA8875_MWCR0_MEMWRDIR_TL : RA8875_MWCR0_MEMWRDIR_LT;
+    _writeRegister(RA8875_MWCR0,_MWCR0_Reg);
+    _writeRegister(RA8875_MRCD, _portrait ? RA8875_MRCD_TL : RA8875_MRCD_LT);    // Same for pixel reads
     setActiveWindow();
 }
 
@@ -761,6 +992,7 @@ void XGLCD::setRotation(uint8_t rotation)//0.69b32 - less code
 /******************************************************************************/
 uint8_t XGLCD::getRotation()
 {
+    _XGP_SCOPE;
 	return _rotation;
 }
 
@@ -771,6 +1003,7 @@ uint8_t XGLCD::getRotation()
 /******************************************************************************/
 boolean XGLCD::isPortrait(void)
 {
+    _XGP_SCOPE;
 	return _portrait;
 }
 
@@ -784,6 +1017,11 @@ boolean XGLCD::isPortrait(void)
   using the RA8875 hardware accelaration.
 */
 
+#define XG_CLIP_OUTSIDE             0                                           // _clipTest results
+#define XG_CLIP_PARTIAL             1
+#define XG_CLIP_INSIDE              2
+#define XG_CLIP_POLY                8                                           // vertices of a clipped polygon: n + 4
+
 /******************************************************************************/
 /*!
  Write a single pixel
@@ -794,9 +1032,24 @@ boolean XGLCD::isPortrait(void)
  NOTE:
  In 8bit bpp RA8875 needs a 8bit color(332) and NOT a 16bit(565),
  the routine deal with this...
+ Pixels outside the screen or the clip rectangle are not drawn.
  */
 /******************************************************************************/
 void XGLCD::drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+    _XGP_SCOPE;
+    if (_dl) { const int16_t p[] = {x,y}; _dl->add(XG_DL_PIXEL, p, 2, color); }
+    if (_clipTest(x, y, x, y) != XG_CLIP_INSIDE) return;
+    _pixel_helper(x, y, color);
+}
+
+/******************************************************************************/
+/*!
+ helper function for a single pixel, x,y must be visible
+ [private]
+ */
+/******************************************************************************/
+void XGLCD::_pixel_helper(int16_t x, int16_t y, uint16_t color)
 {
     if (_textMode) _setTextMode(false);                                         //we are in text mode?
     setXY(x,y);
@@ -810,6 +1063,7 @@ void XGLCD::drawPixel(int16_t x, int16_t y, uint16_t color)
 }
 
 void XGLCD::drawPixel(int16_t x, int16_t y) {
+    _XGP_SCOPE;
     drawPixel(x,y,_foreColor);
 }
 
@@ -824,67 +1078,55 @@ void XGLCD::drawPixel(int16_t x, int16_t y) {
  NOTE:
  In 8bit bpp RA8875 needs a 8bit color(332) and NOT a 16bit(565),
  the routine deals with this...
+ The pixels are streamed in the memory write direction set by setRotation,
+ in portrait mode this is top-down so rotations 1 and 3 run at the same
+ speed as 0 and 2. At the right side of the active window the next pixels
+ continue on the next line.
+ With a clip rectangle (setClipRect) or a start outside the screen only the
+ visible part of line y is drawn, the pixels do not continue on the next line.
  */
 /******************************************************************************/
 void XGLCD::drawPixels(uint16_t p[], uint32_t count, int16_t x, int16_t y)
 {
-    uint32_t i,j;
-    uint16_t temp = 0;
+    _XGP_SCOPE;
+    uint32_t skip;
     
     if (_textMode) _setTextMode(false);                                         //we are in text mode?
+    if (!_clipRun(x, y, count, skip)) return;
+    p += skip;
+    setXY(x,y);
+    writeCommand(RA8875_MRWC);
+    _writePixels16(p, count);
+}
+
+/******************************************************************************/
+/*!
+ Draw a series of 8 bit (RGB332) pixels, see Color565To332
+ Parameters:
+ p: an array of RGB332 colors (pixels)
+ count: how many pixels
+ x: horizontal pos
+ y: vertical pos
+ NOTE:
+ Meant for 8 bit colors (useLayers, setColorBpp(8)): the pixels are send
+ without conversion, 2 pixels per 16 bit SPI frame. With 16 bit colors
+ every pixel is expanded to RGB565 and written on its own (slow).
+ ESP32: p is send with DMA, it must be in DMA capable memory, a 4 byte
+ aligned p is send without an extra copy
+ Clipped as drawPixels, not recorded in a display list.
+ */
+/******************************************************************************/
+void XGLCD::drawPixels8(const uint8_t p[], uint32_t count, int16_t x, int16_t y)
+{
+    _XGP_SCOPE;
+    uint32_t skip;
     
+    if (_textMode) _setTextMode(false);                                         //we are in text mode?
+    if (!_clipRun(x, y, count, skip)) return;
+    p += skip;
     setXY(x,y);
     writeCommand(RA8875_MRWC);
-#ifdef _spiwrite24
-    if (_color_bpp < 16) {                                                      // 8-bit panel, convert the array (it will be overwritten)
-        j = 0;
-        for (i=0;i<count;i+=2) p[j++] = (_color16To8bpp(p[i])<<8) + _color16To8bpp(p[i+1]);
-        count /= 2;                                                             // For odd number of pixels, the last pixel will not be shown, always use even number of pixels
-    }
-    _spiCSLow;
-    if (_portrait) {
-        for (i=0;i<count;i++){
-            _spiwrite24(RA8875_DATAWRITE, temp);
-            _spiCSHigh;
-            x++;
-            setXY(x,y);
-            writeCommand(RA8875_MRWC);
-            _spiCSLow;
-        }
-    } else {
-#ifdef _spixwritedma
-        _spixwritedma(RA8875_DATAWRITE, p, count);
-#else
-        _spiwrite(RA8875_DATAWRITE);
-        _spiwritedma(p, count);
-#endif
-    }
-    _spiCSHigh;
-#else
-    _spiCSLow;
-    _spiwrite(RA8875_DATAWRITE);
-    for (i=0;i<count;i++){
-        if (_color_bpp < 16) {
-            temp = _color16To8bpp(p[i]);                                        //TOTEST:layer bug workaround for 8bit color!
-        } else {
-            temp = p[i];
-        }
-        if (_color_bpp > 8){
-            _spiwrite16(temp);
-        } else {                                                                //TOTEST:layer bug workaround for 8bit color!
-            _spiwrite(temp & 0xFF);
-        }
-        if (_portrait) {                                                        // X-GRAPH: solve bug in drawPixels in portrait mode = a lot slower to draw !!//
-            _spiCSHigh;
-            x++;
-            setXY(x,y);
-            writeCommand(RA8875_MRWC);
-            _spiCSLow;
-            _spiwrite(RA8875_DATAWRITE);
-        }
-    }
-    _spiCSHigh;
-#endif
+    _writePixels8(p, count);
 }
 
 /******************************************************************************/
@@ -893,40 +1135,73 @@ void XGLCD::drawPixels(uint16_t p[], uint32_t count, int16_t x, int16_t y)
  Parameters:
  x: horizontal pos
  y: vertical pos
+ Returns the RGB565 color, with 8 bit colors the RGB332 value as stored
+ (see Color332To565), readRect and getPixels always return RGB565
  */
 /******************************************************************************/
 uint16_t XGLCD::getPixel(int16_t x, int16_t y)
 {
-    uint32_t color, color2;
-    setXY(x,y);
+    _XGP_SCOPE;
+    uint16_t color;
+    
     if (_textMode) _setTextMode(false);                                         //we are in text mode?
+    _setReadCursor(x,y);
     writeCommand(RA8875_MRWC);
-    _spisetSpeed(SPI_SPEED_READ);
-    _spiCSLow;
-#ifdef _spixbread
-    if (_color_bpp > 8) {
-        _spixbread(RA8875_DATAREAD, color, 32);
-        color >>= 16;
-    } else {
-        _spixbread(RA8875_DATAREAD, color, 16);
-        color >>= 8;
-    }
-#else
-    _spiwrite(RA8875_DATAREAD);
-    if (_color_bpp > 8) {
-        _spiwrite(0x00);                                                            //first word it's dummy
-        _spiwrite(0x00);
-        _spiread(color2);
-        _spiread(color);
-        color |= (color2 << 8);
-    } else {
-        _spiwrite(0x00);                                                            //first byte it's dummy
-        _spiread(color);
-    }
-#endif
-    _spiCSHigh;
-    _spisetSpeed(SPI_SPEED_WRITE);
-    return (uint16_t)color;
+    _readPixels(&color, 1, 1, 1);
+    if (_color_bpp < 16) color = Color565To332(color);                          // Back to the stored value, the expansion is lossless
+    return color;
+}
+
+/******************************************************************************/
+/*!
+ Read pixels from screen, the counterpart of drawPixels
+ Parameters:
+ p: buffer for count RGB565 colors
+ count: number of pixels
+ x,y: start position, the read continues like drawPixels within the active window
+ */
+/******************************************************************************/
+void XGLCD::getPixels(uint16_t * p, uint32_t count, int16_t x, int16_t y)
+{
+    _XGP_SCOPE;
+    if (count == 0) return;
+    if (_textMode) _setTextMode(false);                                         //we are in text mode?
+    _setReadCursor(x,y);
+    writeCommand(RA8875_MRWC);
+    _readPixels(p, count, count, count);
+}
+
+/******************************************************************************/
+/*!
+ Read a rectangle from screen, for screenshots, alpha blending or to save and
+ restore the background under a sprite (write it back with blit)
+ Parameters:
+ x,y: top left position
+ w,h: size
+ dst: buffer for w*h RGB565 colors, line by line
+ NOTE:
+ The rectangle is read in one transaction with a single dummy read, the memory
+ read cursor wraps within a temporary active window. Pixels outside the screen
+ are not read, their place in dst is left untouched.
+ */
+/******************************************************************************/
+void XGLCD::readRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t *dst)
+{
+    _XGP_SCOPE;
+    int32_t x1 = x, y1 = y, x2 = (int32_t)x + w - 1, y2 = (int32_t)y + h - 1;
+    
+    if (x1 < 0) x1 = 0;
+    if (y1 < 0) y1 = 0;
+    if (x2 >= _width) x2 = _width - 1;
+    if (y2 >= _height) y2 = _height - 1;
+    if (w <= 0 || h <= 0 || x1 > x2 || y1 > y2) return;
+    dst += (uint32_t)(y1 - y) * w + (x1 - x);
+    
+    _setTempWindow(x1, y1, x2 - x1 + 1, y2 - y1 + 1);
+    _setReadCursor(x1, y1);
+    writeCommand(RA8875_MRWC);
+    _readPixels(dst, (uint32_t)(x2 - x1 + 1) * (y2 - y1 + 1), x2 - x1 + 1, w);
+    _blitEnd();
 }
 
 /******************************************************************************/
@@ -938,6 +1213,7 @@ uint16_t XGLCD::getPixel(int16_t x, int16_t y)
  */
 /******************************************************************************/
 void XGLCD::pushPixels(uint32_t num, uint16_t p) {
+    _XGP_SCOPE;
     if (_textMode) _setTextMode(false);                                         //we are in text mode?
 
     //setXY(x,y);
@@ -950,14 +1226,15 @@ void XGLCD::pushPixels(uint32_t num, uint16_t p) {
             _writeData16((RA8875_DATAWRITE<<8) + _color16To8bpp(p));
         }
     }
+#elif defined(_spiwritebuf)
+    _spiwrite(RA8875_DATAWRITE);
+    _writeStaged(NULL, p, num);
 #else
     _spiwrite(RA8875_DATAWRITE);
-    while (num--) {
-        if (_color_bpp > 8) {
-            _spiwrite16(p);
-        } else {
-            _writeData(_color16To8bpp(p));
-        }
+    if (_color_bpp > 8) {
+        while (num--) _spiwrite16(p);
+    } else {
+        while (num--) _writeData(_color16To8bpp(p));
     }
 #endif
     _spiCSHigh;
@@ -973,12 +1250,18 @@ void XGLCD::pushPixels(uint32_t num, uint16_t p) {
 /******************************************************************************/
 void XGLCD::fillWindow(uint16_t color)
 {
+    _XGP_SCOPE;
+    bool window;
+    
+    if (_dl) _dl->add(XG_DL_FILLWIN, NULL, 0, color);
+    if (!_clipEngine(0, 0, _width - 1, _height - 1, window)) return;
     _line_addressing(0,0,LCD_WIDTH-1, LCD_HEIGHT-1);
     setForegroundColor(color);
     writeCommand(RA8875_DCR);
     _writeData(0xB0);
-    _waitPoll(RA8875_DCR, RA8875_DCR_LINESQUTRI_STATUS);
+    _waitEngine(RA8875_DCR, RA8875_DCR_LINESQUTRI_STATUS);
     _TXTrecoverColor = true;
+    if (window) _blitEnd();
 }
 
 /******************************************************************************/
@@ -992,6 +1275,7 @@ void XGLCD::fillWindow(uint16_t color)
 /******************************************************************************/
 void XGLCD::clearScreen(uint16_t color)
 {
+    _XGP_SCOPE;
     setActiveWindow();
     fillWindow(color);
 }
@@ -1010,6 +1294,7 @@ void XGLCD::clearScreen(uint16_t color)
 /******************************************************************************/
 void XGLCD::drawMesh(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t spacing, uint16_t color)
 {
+    _XGP_SCOPE;
     if (spacing < 2) spacing = 2;
     if (((x + w) - 1) >= _width)  w = _width  - x;
     if (((y + h) - 1) >= _height) h = _height - y;
@@ -1037,15 +1322,44 @@ void XGLCD::drawMesh(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t spacing
  NOTE:
  Remember that this write from->to so: drawLine(0,0,2,0,RA8875_RED);
  result a 3 pixel long! (0..1..2)
+ The end points can be outside the screen, the line is clipped to the screen
+ and the clip rectangle.
  */
 /******************************************************************************/
 void XGLCD::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color)
 {
+    _XGP_SCOPE;
     if ((x0 == x1 && y0 == y1)) {
         drawPixel(x0,y0,color);
         return;
     }
+    if (_dl) { const int16_t p[] = {x0,y0,x1,y1}; _dl->add(XG_DL_LINE, p, 4, color); }
+    _line_helper(x0, y0, x1, y1, color);
+}
+
+/******************************************************************************/
+/*!
+ helper function for lines
+ [private]
+ NOTE:
+ The engine needs the end points on the screen, otherwise only the part on
+ the screen (_clipLine) is drawn. A line that crosses the clip rectangle is
+ drawn in a temporary active window: the same pixels as without clipping.
+ */
+/******************************************************************************/
+void XGLCD::_line_helper(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color)
+{
+    bool window;
     
+    if (x0 < 0 || y0 < 0 || x0 >= _width || y0 >= _height ||
+        x1 < 0 || y1 < 0 || x1 >= _width || y1 >= _height) {
+        if (!_clipLine(x0, y0, x1, y1)) return;
+    }
+    if (x0 == x1 && y0 == y1) {                                                 // Single pixel
+        if (_clipTest(x0, y0, x0, y0) == XG_CLIP_INSIDE) _pixel_helper(x0, y0, color);
+        return;
+    }
+    if (!_clipEngine(x0, y0, x1, y1, window)) return;
     _TXTrecoverColor = true;
     if (color != _foreColor) setForegroundColor(color);
     
@@ -1053,10 +1367,12 @@ void XGLCD::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t co
     if (_textMode) _setTextMode(false);                                         //we are in text mode?
     _line_addressing(x0,y0,x1,y1);
     _writeRegister(RA8875_DCR,0x80);
-    _waitPoll(RA8875_DCR, RA8875_DCR_LINESQUTRI_STATUS);
+    _waitEngine(RA8875_DCR, RA8875_DCR_LINESQUTRI_STATUS);
+    if (window) _blitEnd();
 }
 
 void XGLCD::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    _XGP_SCOPE;
     drawLine(x0, y0, x1, y1, _foreColor);
 }
 
@@ -1073,6 +1389,7 @@ void XGLCD::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
 /******************************************************************************/
 void XGLCD::drawLineAngle(int16_t x, int16_t y, int16_t angle, uint16_t length, uint16_t color,int offset)
 {
+    _XGP_SCOPE;
     
     if (length < 2) {
         drawPixel(x,y,color);
@@ -1081,8 +1398,8 @@ void XGLCD::drawLineAngle(int16_t x, int16_t y, int16_t angle, uint16_t length,
         drawLine(
                  x,
                  y,
-                 x + round((length) * _cosDeg_helper(angle + offset)),
-                 y + round((length) * _sinDeg_helper(angle + offset)),
+                 x + xgMulQ15(length, xgCosDeg(angle + offset)),
+                 y + xgMulQ15(length, xgSinDeg(angle + offset)),
                  color);
     }
 }
@@ -1101,15 +1418,16 @@ void XGLCD::drawLineAngle(int16_t x, int16_t y, int16_t angle, uint16_t length,
 /******************************************************************************/
 void XGLCD::drawLineAngle(int16_t x, int16_t y, int16_t angle, uint16_t start, uint16_t length, uint16_t color,int offset)
 {
+    _XGP_SCOPE;
     if (start - length < 2) {
         drawPixel(x,y,color);
     } else {
         length--;
         drawLine(
-                 x + round(start * _cosDeg_helper(angle + offset)),
-                 y + round(start * _sinDeg_helper(angle + offset)),
-                 x + round((start + length) * _cosDeg_helper(angle + offset)),
-                 y + round((start + length) * _sinDeg_helper(angle + offset)),
+                 x + xgMulQ15(start, xgCosDeg(angle + offset)),
+                 y + xgMulQ15(start, xgSinDeg(angle + offset)),
+                 x + xgMulQ15(start + length, xgCosDeg(angle + offset)),
+                 y + xgMulQ15(start + length, xgSinDeg(angle + offset)),
                  color);
     }
 }
@@ -1126,6 +1444,7 @@ void XGLCD::drawLineAngle(int16_t x, int16_t y, int16_t angle, uint16_t start, u
 /******************************************************************************/
 void XGLCD::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
 {
+    _XGP_SCOPE;
     
     if (h < 1) h = 1;
     h < 2 ? drawPixel(x,y,color) : drawLine(x, y, x, (y+h)-1, color);
@@ -1143,6 +1462,7 @@ void XGLCD::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
 /******************************************************************************/
 void XGLCD::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
 {
+    _XGP_SCOPE;
     if (w < 1) w = 1;
     w < 2 ? drawPixel(x,y,color) : drawLine(x, y, (w+x)-1, y, color);
 }
@@ -1160,6 +1480,7 @@ void XGLCD::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
 /******************************************************************************/
 void XGLCD::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
 {
+    _XGP_SCOPE;
     //RA8875 is not out-of-range tolerant so this is a workaround
     if (w < 1 || h < 1) return;                                                 //it cannot be!
     if (w < 2 && h < 2){                                                        //render as pixel
@@ -1170,6 +1491,7 @@ void XGLCD::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
 }
 
 void XGLCD::drawRect(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    _XGP_SCOPE;
     drawRect(x0, y0, x1-x0+1, y1-y0+1, _foreColor);
 }
 
@@ -1186,6 +1508,7 @@ void XGLCD::drawRect(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
 /******************************************************************************/
 void XGLCD::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
 {
+    _XGP_SCOPE;
     //RA8875 it's not out-of-range tolerant so this is a workaround
     if (w < 1 || h < 1) return;                                                 //it cannot be!
     if (w < 2 && h < 2){                                                        //render as pixel
@@ -1196,9 +1519,163 @@ void XGLCD::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
 }
 
 void XGLCD::fillRect(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    _XGP_SCOPE;
     fillRect(x0, y0, x1-x0+1, y1-y0+1, _foreColor);
 }
 
+/******************************************************************************/
+/*!
+ Batched primitives: draw an array of filled rectangles, lines or pixels
+ The text mode check is done once, each shape (color, coordinates and start)
+ is send as one register burst and the draw engine runs while the next shape
+ is prepared (the wait is done as in pipelined mode, see usePipeline)
+ Parameters:
+ rects, lines, points: the shapes
+ n: number of shapes
+ color: RGB565 color of all shapes
+ colors: RGB565 color per shape
+ NOTE:
+ With a color per shape, up to XG_BATCH_SORT shapes at a time are drawn sorted
+ by color: overlapping shapes with a different color can be drawn in another
+ order. Points outside the screen are skipped (drawPixel draws them on the edge).
+ */
+/******************************************************************************/
+#define XG_BATCH_SORT               32                                          // shapes sorted by color at a time
+
+void XGLCD::fillRects(const tRect *rects, uint16_t n, uint16_t color)
+{
+    _XGP_SCOPE;
+    _batchShapes((const int16_t *)rects, n, color, NULL, true);
+}
+
+void XGLCD::fillRects(const tRect *rects, uint16_t n, const uint16_t *colors)
+{
+    _XGP_SCOPE;
+    _batchShapes((const int16_t *)rects, n, 0, colors, true);
+}
+
+void XGLCD::drawLines(const tSegment *lines, uint16_t n, uint16_t color)
+{
+    _XGP_SCOPE;
+    _batchShapes((const int16_t *)lines, n, color, NULL, false);
+}
+
+void XGLCD::drawLines(const tSegment *lines, uint16_t n, const uint16_t *colors)
+{
+    _XGP_SCOPE;
+    _batchShapes((const int16_t *)lines, n, 0, colors, false);
+}
+
+void XGLCD::plotPoints(const tPoint *points, uint16_t n, uint16_t color)
+{
+    _XGP_SCOPE;
+    int16_t x, y, cx1, cy1, cx2, cy2;
+    uint8_t c8 = _color16To8bpp(color);
+    
+    if (n == 0) return;
+    _clipBox(cx1, cy1, cx2, cy2);
+    if (_textMode) _setTextMode(false);                                         //we are in text mode?
+    _queueRegister(RA8875_MWCR0, _MWCR0_Reg | RA8875_MWCR0_MEMWR_NO_INC);       // The cursor does not move, so its shadow stays valid
+    for (; n; n--, points++) {
+        x = points->x;
+        y = points->y;
+        if (x < cx1 || y < cy1 || x > cx2 || y > cy2) continue;
+        if (_dl) { const int16_t p[] = {x,y}; _dl->add(XG_DL_PIXEL, p, 2, color); }
+        if (_portrait) swapvals(x,y);
+        _queueRegister(RA8875_CURH0, x & 0xFF);                                 // Only the changed cursor bytes are send
+        _queueRegister(RA8875_CURH0+1, x >> 8);
+        _queueRegister(RA8875_CURV0, y & 0xFF);
+        _queueRegister(RA8875_CURV0+1, y >> 8);
+        if (_color_bpp > 8) {
+            _queueRegister(RA8875_MRWC, color >> 8);
+            _queueData(color & 0xFF);
+        } else {
+            _queueRegister(RA8875_MRWC, c8);
+        }
+    }
+    _queueRegister(RA8875_MWCR0, _MWCR0_Reg);
+    _flushRegisters();
+}
+
+/******************************************************************************/
+/*!
+ Draw the shapes of fillRects and drawLines
+ [private]
+ Parameters:
+ items: tRect or tSegment array (4 int16_t per shape)
+ n, color, colors: see fillRects
+ rects: true = items are tRect
+ */
+/******************************************************************************/
+void XGLCD::_batchShapes(const int16_t *items, uint16_t n, uint16_t color, const uint16_t *colors, bool rects)
+{
+    uint8_t idx[XG_BATCH_SORT];
+    const int16_t *p;
+    bool pipeline = _pipeline;
+    uint16_t base, m, i, j;
+    
+    if (n == 0) return;
+    if (_textMode) _setTextMode(false);                                         //we are in text mode?
+    _TXTrecoverColor = true;
+    _pipeline = true;
+    for (base = 0; base < n; base += m) {
+        m = (n - base < XG_BATCH_SORT) ? n - base : XG_BATCH_SORT;
+        for (i = 0; i < m; i++) {                                               // Stable insertion sort on color
+            j = i;
+            if (colors != NULL) {
+                for (; j > 0 && colors[base + idx[j-1]] > colors[base + i]; j--) idx[j] = idx[j-1];
+            }
+            idx[j] = i;
+        }
+        for (i = 0; i < m; i++) {
+            j = base + idx[i];
+            p = items + (j * 4);
+            if (colors != NULL) color = colors[j];
+            if (!rects) {
+                _batchShape(p[0], p[1], p[2], p[3], color, false);
+            } else if (p[2] > 0 && p[3] > 0) {
+                _batchShape(p[0], p[1], p[0] + p[2] - 1, p[1] + p[3] - 1, color, true);
+            }
+        }
+    }
+    _pipeline = pipeline;
+    if (!pipeline) _syncEngine();
+}
+
+/******************************************************************************/
+/*!
+ One shape of a batch: color, coordinates and start in one register burst
+ [private]
+ Parameters:
+ x0,y0,x1,y1: line end points or rectangle corners
+ color: RGB565 color
+ rect: filled rectangle (true) or line
+ */
+/******************************************************************************/
+void XGLCD::_batchShape(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color, bool rect)
+{
+    if (x0 == x1 && y0 == y1) {                                                 // as fillRect and drawLine
+        drawPixel(x0, y0, color);
+        return;
+    }
+    if (_dl) { const int16_t p[] = {x0,y0,x1,y1}; _dl->add(rect ? XG_DL_FILLRECT : XG_DL_LINE, p, 4, color); }
+    if (!rect && _clipTest(x0, y0, x1, y1) != XG_CLIP_INSIDE) {                 // Partly visible line
+        _line_helper(x0, y0, x1, y1, color);
+        return;
+    }
+    if (rect && !_clipRect(x0, y0, x1, y1)) return;
+    if (x0 == x1 && y0 == y1) {
+        _pixel_helper(x0, y0, color);
+        return;
+    }
+    if (_portrait) {swapvals(x0,y0); swapvals(x1,y1);}
+    if (color != _foreColor) _queueForegroundColor(color);
+    _line_addressing(x0, y0, x1, y1, false);
+    _queueRegister(RA8875_DCR, rect ? 0xB0 : 0x80);
+    _flushRegisters();
+    _waitEngine(RA8875_DCR, RA8875_DCR_LINESQUTRI_STATUS);
+}
+
 /******************************************************************************/
 /*!
  Draw a rounded rectangle
@@ -1215,6 +1692,7 @@ void XGLCD::fillRect(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
 /******************************************************************************/
 void XGLCD::drawRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color)
 {
+    _XGP_SCOPE;
     if (r == 0) {drawRect(x,y,w,h,color); return;}                              // X-GRAPH: return added
     if (w < 1 || h < 1) return;                                                 //it cannot be!
     if (w < 2 && h < 2){                                                        //render as pixel
@@ -1228,6 +1706,7 @@ void XGLCD::drawRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r,
 }
 
 void XGLCD::drawRoundRect(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    _XGP_SCOPE;
     drawRoundRect(x0, y0, x1-x0+1, y1-y0+1, 2, _foreColor);
 }
 
@@ -1245,6 +1724,7 @@ void XGLCD::drawRoundRect(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
 /******************************************************************************/
 void XGLCD::fillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color)
 {
+    _XGP_SCOPE;
     if (r == 0) {fillRect(x,y,w,h,color); return;}                              // X-GRAPH: return added
     if (w < 1 || h < 1) return;                                                 //it cannot be!
     if (w < 2 && h < 2){                                                        //render as pixel
@@ -1258,6 +1738,7 @@ void XGLCD::fillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r,
 }
 
 void XGLCD::fillRoundRect(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+    _XGP_SCOPE;
     fillRoundRect(x0, y0, x1-x0+1, y1-y0+1, 2, _foreColor);
 }
 
@@ -1273,6 +1754,7 @@ void XGLCD::fillRoundRect(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
 /******************************************************************************/
 void XGLCD::drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color)
 {
+    _XGP_SCOPE;
     _center_helper(x0,y0);                                                      // check for x or y CENTER -> width/height / 2
     //if (r < 1) return;                                                        // X-GRAPH removed cause code is also in _circle_helper
     //if (r < 2) {
@@ -1283,6 +1765,7 @@ void XGLCD::drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color)
 }
 
 void XGLCD::drawCircle(int16_t x0, int16_t y0, int16_t r) {
+    _XGP_SCOPE;
     drawCircle(x0, y0, r, _foreColor);
 }
 
@@ -1299,6 +1782,7 @@ void XGLCD::drawCircle(int16_t x0, int16_t y0, int16_t r) {
 
 void XGLCD::fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color)
 {
+    _XGP_SCOPE;
     _center_helper(x0,y0);
     //if (r < 1) return;                                                        // X-GRAPH removed cause code is also in _circle_helper
     //if (r == 1) {
@@ -1309,6 +1793,7 @@ void XGLCD::fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color)
 }
 
 void XGLCD::fillCircle(int16_t x0, int16_t y0, int16_t r) {
+    _XGP_SCOPE;
     fillCircle(x0, y0, r, _foreColor);
 }
 
@@ -1333,6 +1818,7 @@ void XGLCD::drawArc(uint16_t cx, uint16_t cy, uint16_t radius, uint16_t thicknes
 /******************************************************************************/
 void XGLCD::setArcParams(float arcAngleMax, int arcAngleOffset)
 {
+    _XGP_SCOPE;
     _arcAngle_max = arcAngleMax;
     _arcAngle_offset = arcAngleOffset;
 }
@@ -1344,6 +1830,7 @@ void XGLCD::setArcParams(float arcAngleMax, int arcAngleOffset)
 /******************************************************************************/
 void XGLCD::setAngleOffset(int16_t angleOffset)
 {
+    _XGP_SCOPE;
     _angle_offset = ANGLE_OFFSET + angleOffset;
 }
 
@@ -1364,6 +1851,7 @@ void XGLCD::setAngleOffset(int16_t angleOffset)
 /******************************************************************************/
 void XGLCD::drawQuad(int16_t x0, int16_t y0,int16_t x1, int16_t y1,int16_t x2, int16_t y2,int16_t x3, int16_t y3, uint16_t color)
 {
+    _XGP_SCOPE;
     drawLine(x0, y0, x1, y1, color);
     drawLine(x1, y1, x2, y2, color);
     drawLine(x2, y2, x3, y3, color);
@@ -1390,6 +1878,7 @@ void XGLCD::drawQuad(int16_t x0, int16_t y0,int16_t x1, int16_t y1,int16_t x2, i
 /******************************************************************************/
 void XGLCD::fillQuad(int16_t x0, int16_t y0,int16_t x1, int16_t y1,int16_t x2, int16_t y2, int16_t x3, int16_t y3, uint16_t color, bool triangled)
 {
+    _XGP_SCOPE;
     _triangle_helper(x0, y0, x1, y1, x2, y2, color,true);
     if (triangled) _triangle_helper(x2, y2, x3, y3, x0, y0, color,true);
     _triangle_helper(x1, y1, x2, y2, x3, y3, color,true);
@@ -1409,18 +1898,21 @@ void XGLCD::fillQuad(int16_t x0, int16_t y0,int16_t x1, int16_t y1,int16_t x2, i
 /******************************************************************************/
 void XGLCD::drawPolygon(int16_t cx, int16_t cy, uint8_t sides, int16_t diameter, float rot, uint16_t color)
 {
+    _XGP_SCOPE;
     _center_helper(cx,cy);
     sides = (sides > 2? sides : 3);
-    float dtr = (PI / 180.0) + PI;
-    float rads = 360.0 / sides;                                                 //points spacd equally
+    int32_t a0 = xgDeci(rot), a1;                                               // tenths of a degree
+    int16_t x0 = cx + xgMulQ15(diameter, xgSinDeci(a0));
+    int16_t y0 = cy + xgMulQ15(diameter, xgCosDeci(a0));
+    int16_t x1, y1;
     uint8_t i;
-    for (i = 0; i < sides; i++) {
-        drawLine(
-                 cx + (sin((i*rads + rot) * dtr) * diameter),
-                 cy + (cos((i*rads + rot) * dtr) * diameter),
-                 cx + (sin(((i+1)*rads + rot) * dtr) * diameter),
-                 cy + (cos(((i+1)*rads + rot) * dtr) * diameter),
-                 color);
+    for (i = 1; i <= sides; i++) {
+        a1 = a0 + (i * 3600L) / sides;                                          //points spaced equally
+        x1 = cx + xgMulQ15(diameter, xgSinDeci(a1));
+        y1 = cy + xgMulQ15(diameter, xgCosDeci(a1));
+        drawLine(x0, y0, x1, y1, color);
+        x0 = x1;
+        y0 = y1;
     }
 }
 
@@ -1439,6 +1931,7 @@ void XGLCD::drawPolygon(int16_t cx, int16_t cy, uint8_t sides, int16_t diameter,
 /******************************************************************************/
 void XGLCD::drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color)
 {
+    _XGP_SCOPE;
     _triangle_helper(x0, y0, x1, y1, x2, y2, color, false);
 }
 
@@ -1457,6 +1950,7 @@ void XGLCD::drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t
 /******************************************************************************/
 void XGLCD::fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color)
 {
+    _XGP_SCOPE;
     _triangle_helper(x0, y0, x1, y1, x2, y2, color, true);
 }
 
@@ -1473,6 +1967,7 @@ void XGLCD::fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t
 /******************************************************************************/
 void XGLCD::drawEllipse(int16_t xCenter, int16_t yCenter, int16_t longAxis, int16_t shortAxis, uint16_t color)
 {
+    _XGP_SCOPE;
     _ellipseCurve_helper(xCenter, yCenter, longAxis, shortAxis, 255, color, false);
 }
 
@@ -1489,6 +1984,7 @@ void XGLCD::drawEllipse(int16_t xCenter, int16_t yCenter, int16_t longAxis, int1
 /******************************************************************************/
 void XGLCD::fillEllipse(int16_t xCenter, int16_t yCenter, int16_t longAxis, int16_t shortAxis, uint16_t color)
 {
+    _XGP_SCOPE;
     _ellipseCurve_helper(xCenter, yCenter, longAxis, shortAxis, 255, color, true);
 }
 
@@ -1506,6 +2002,7 @@ void XGLCD::fillEllipse(int16_t xCenter, int16_t yCenter, int16_t longAxis, int1
 /******************************************************************************/
 void XGLCD::drawCurve(int16_t xCenter, int16_t yCenter, int16_t longAxis, int16_t shortAxis, uint8_t curvePart, uint16_t color)
 {
+    _XGP_SCOPE;
     curvePart = curvePart % 4;
     if (_portrait) {
         if (curvePart == 0) {
@@ -1531,6 +2028,7 @@ void XGLCD::drawCurve(int16_t xCenter, int16_t yCenter, int16_t longAxis, int16_
 /******************************************************************************/
 void XGLCD::fillCurve(int16_t xCenter, int16_t yCenter, int16_t longAxis, int16_t shortAxis, uint8_t curvePart, uint16_t color)
 {
+    _XGP_SCOPE;
     curvePart = curvePart % 4;
     if (_portrait) {
         if (curvePart == 0) {
@@ -1557,29 +2055,196 @@ void XGLCD::fillCurve(int16_t xCenter, int16_t yCenter, int16_t longAxis, int16_
 
 void XGLCD::setXY(int16_t x, int16_t y)
 {
-    setX(x);
-    setY(y);
+    _XGP_SCOPE;
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (_portrait) swapvals(x,y);
+    if (x >= LCD_WIDTH) x = LCD_WIDTH-1;
+    if (y >= LCD_HEIGHT) y = LCD_HEIGHT-1;
+    _queueRegister(RA8875_CURH0, x & 0xFF);
+    _queueRegister(RA8875_CURH0+1, x >> 8);
+    _queueRegister(RA8875_CURV0, y & 0xFF);
+    _queueRegister(RA8875_CURV0+1, y >> 8);
+    _flushRegisters();
 }
 
 /******************************************************************************/
 /*!
- Set the x position for Graphic Write
+ Stream a screenshot as a BMP file (16 bit RGB565, top-down)
  Parameters:
- x: horizontal position
+ out: Serial, a WiFiClient, an SD File... (any Print object)
+ layer: -1 = the displayed layer, 0/1 = layer 1/2 in 2 layer mode
+ NOTE:
+ The screen is read in chunks of XG_CAPTURE_CHUNK pixels as one continuous memory
+ read, no frame buffer is needed. The file size is 66 + width() * height() * 2
+ bytes (for an HTTP Content-Length). In 2 layer mode the layer mixing effects
+ are not applied, the displayed layer is layer 2 only if it is the only visible
+ layer. At 8 bpp the colors are expanded to RGB565.
  */
 /******************************************************************************/
-void XGLCD::setX(int16_t x)
+#define XG_CAPTURE_CHUNK            64                                          // pixels read and sent at a time
+
+static void _putLE(uint8_t *p, uint32_t v, uint8_t n)
 {
-    if (x < 0) x = 0;
-    if (_portrait){
+    while (n--) {
+        *p++ = v & 0xFF;
+        v >>= 8;
+    }
+}
+
+void XGLCD::captureScreen(Print &out, int8_t layer)
+{
+    _XGP_SCOPE;
+    uint8_t hdr[66];
+    uint16_t buf[XG_CAPTURE_CHUNK];
+    uint8_t bytes[XG_CAPTURE_CHUNK * 2];
+    uint32_t rowBytes = ((uint32_t)_width * 2 + 3) & ~3UL;
+    uint32_t imageSize = rowBytes * _height;
+    uint8_t mwcr1 = 0;
+    uint16_t x, y, n, i;
+    bool first = true;
+    
+    memset(hdr, 0, sizeof(hdr));
+    hdr[0] = 'B'; hdr[1] = 'M';
+    _putLE(&hdr[2], sizeof(hdr) + imageSize, 4);                                // File size
+    _putLE(&hdr[10], sizeof(hdr), 4);                                           // Pixel data offset
+    _putLE(&hdr[14], 40, 4);                                                    // BITMAPINFOHEADER
+    _putLE(&hdr[18], _width, 4);
+    _putLE(&hdr[22], -(int32_t)_height, 4);                                     // Negative: top-down, the order the screen is read in
+    _putLE(&hdr[26], 1, 2);                                                     // Planes
+    _putLE(&hdr[28], 16, 2);                                                    // Bits per pixel
+    _putLE(&hdr[30], 3, 4);                                                     // BI_BITFIELDS
+    _putLE(&hdr[34], imageSize, 4);
+    _putLE(&hdr[38], 2835, 4);                                                  // 72 dpi
+    _putLE(&hdr[42], 2835, 4);
+    _putLE(&hdr[54], 0xF800, 4);                                                // Red, green and blue masks
+    _putLE(&hdr[58], 0x07E0, 4);
+    _putLE(&hdr[62], 0x001F, 4);
+    out.write(hdr, sizeof(hdr));
+    
+    _setTempWindow(0, 0, _width, _height);
+    if (_useMultiLayers) {
+        mwcr1 = _readRegister(RA8875_MWCR1);
+        if (layer < 0) layer = ((_readRegister(RA8875_LTPR0) & 0x07) == 0x01) ? 1 : 0;
+        _writeRegister(RA8875_MWCR1, (mwcr1 & ~0x01) | (layer & 0x01));         // Layer for read/write
+    }
+    _setReadCursor(0, 0);
+    writeCommand(RA8875_MRWC);
+    for (y = 0; y < _height; y++) {
+        for (x = 0; x < _width; x += n) {
+            n = (_width - x < XG_CAPTURE_CHUNK) ? _width - x : XG_CAPTURE_CHUNK;
+            _readPixels(buf, n, n, n, first);
+            first = false;
+            for (i = 0; i < n; i++) {
+                bytes[i * 2] = buf[i] & 0xFF;
+                bytes[i * 2 + 1] = buf[i] >> 8;
+            }
+            out.write(bytes, n * 2);
+        }
+        if (rowBytes > (uint32_t)_width * 2) {                                  // Rows are padded to 4 bytes
+            bytes[0] = bytes[1] = 0;
+            out.write(bytes, 2);
+        }
+    }
+    if (_useMultiLayers) _writeRegister(RA8875_MWCR1, mwcr1);
+    _blitEnd();
+}
+
+/******************************************************************************/
+/*!
+ Set the position for Graphic Read (memory read cursor)
+ [private]
+ Parameters:
+ x: horizontal position
+ y: vertical position
+ */
+/******************************************************************************/
+void XGLCD::_setReadCursor(int16_t x, int16_t y)
+{
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (_portrait) swapvals(x,y);
+    if (x >= LCD_WIDTH) x = LCD_WIDTH-1;
+    if (y >= LCD_HEIGHT) y = LCD_HEIGHT-1;
+    _queueRegister(RA8875_RCURH0, x & 0xFF);
+    _queueRegister(RA8875_RCURH0+1, x >> 8);
+    _queueRegister(RA8875_RCURV0, y & 0xFF);
+    _queueRegister(RA8875_RCURV0+1, y >> 8);
+    _flushRegisters();
+}
+
+/******************************************************************************/
+/*!
+ Read pixels after MRWC in one memory read (only one dummy read)
+ [private]
+ Parameters:
+ dst: RGB565 destination
+ count: number of pixels
+ width: pixels per line in dst
+ stride: distance between the lines in dst (in pixels)
+ first: first read after MRWC or a new read cursor (starts with a dummy read),
+ false continues the previous read
+ */
+/******************************************************************************/
+void XGLCD::_readPixels(uint16_t *dst, uint32_t count, uint32_t width, uint32_t stride, bool first)
+{
+    uint8_t buf[60];                                                            // ESP32: command + data fit in the 64 byte SPI buffer
+    uint8_t bpp = (_color_bpp > 8) ? 2 : 1;
+    uint32_t skip = first ? bpp : 0;                                            // Dummy pixel
+    uint32_t n = count * bpp + skip;
+    uint32_t col = 0, len, i;
+    
+    _spisetSpeed(SPI_SPEED_READ);
+#ifndef _spixreadbuf
+    _spiCSLow;
+    _spiwrite(RA8875_DATAREAD);
+#endif
+    while (n) {
+        len = (n > sizeof(buf)) ? sizeof(buf) : n;                              // Even: a 16 bit pixel is never split
+#ifdef _spixreadbuf
+        _spixreadbuf(RA8875_DATAREAD, buf, len);
+#else
+        for (i = 0; i < len; i++) {
+            _spiread(buf[i]);
+        }
+#endif
+        n -= len;
+        for (i = skip; i < len; i += bpp) {
+            *dst++ = (bpp == 2) ? ((buf[i] << 8) | buf[i + 1]) : Color332To565(buf[i]);
+            if (++col == width) {
+                col = 0;
+                dst += stride - width;
+            }
+        }
+        skip = 0;
+    }
+#ifndef _spixreadbuf
+    _spiCSHigh;
+#endif
+    _spisetSpeed(SPI_SPEED_WRITE);
+}
+
+/******************************************************************************/
+/*!
+ Set the x position for Graphic Write
+ Parameters:
+ x: horizontal position
+ */
+/******************************************************************************/
+void XGLCD::setX(int16_t x)
+{
+    _XGP_SCOPE;
+    if (x < 0) x = 0;
+    if (_portrait){
         if (x >= LCD_HEIGHT) x = LCD_HEIGHT-1;
-        _writeRegister(RA8875_CURV0, x & 0xFF);
-        _writeRegister(RA8875_CURV0+1, x >> 8);
+        _queueRegister(RA8875_CURV0, x & 0xFF);
+        _queueRegister(RA8875_CURV0+1, x >> 8);
     } else {
         if (x >= LCD_WIDTH) x = LCD_WIDTH-1;
-        _writeRegister(RA8875_CURH0, x & 0xFF);
-        _writeRegister(RA8875_CURH0+1, (x >> 8));
+        _queueRegister(RA8875_CURH0, x & 0xFF);
+        _queueRegister(RA8875_CURH0+1, (x >> 8));
     }
+    _flushRegisters();
 }
 
 /******************************************************************************/
@@ -1591,16 +2256,18 @@ void XGLCD::setX(int16_t x)
 /******************************************************************************/
 void XGLCD::setY(int16_t y)
 {
+    _XGP_SCOPE;
     if (y < 0) y = 0;
     if (_portrait){
         if (y >= LCD_WIDTH) y = LCD_WIDTH-1;
-        _writeRegister(RA8875_CURH0, y & 0xFF);
-        _writeRegister(RA8875_CURH0+1, (y >> 8));
+        _queueRegister(RA8875_CURH0, y & 0xFF);
+        _queueRegister(RA8875_CURH0+1, (y >> 8));
     } else {
         if (y >= LCD_HEIGHT) y = LCD_HEIGHT-1;
-        _writeRegister(RA8875_CURV0, y & 0xFF);
-        _writeRegister(RA8875_CURV0+1, y >> 8);
+        _queueRegister(RA8875_CURV0, y & 0xFF);
+        _queueRegister(RA8875_CURV0+1, y >> 8);
     }
+    _flushRegisters();
 }
 
 
@@ -1634,12 +2301,24 @@ float XGLCD::_check_area(int16_t Ax, int16_t Ay, int16_t Bx, int16_t By, int16_t
 /******************************************************************************/
 void XGLCD::_circle_helper(int16_t x0, int16_t y0, int16_t r, uint16_t color, bool filled) // fixed an undocumented hardware limit
 {
+    bool window;
     
     if (r < 1) r = 1;
     if (r < 2) {
         drawPixel(x0,y0,color);
         return;
     }
+    if (_dl) { const int16_t p[] = {x0,y0,r}; _dl->add(filled ? XG_DL_FILLCIRCLE : XG_DL_CIRCLE, p, 3, color); }
+    
+    if (x0 < 0 || y0 < 0 || x0 >= _width || y0 >= _height) {                    // The engine needs the center on the screen: clipped spans
+        if (_clipTest(x0 - r, y0 - r, x0 + r, y0 + r) == XG_CLIP_OUTSIDE) return;
+        XGDisplayList *dl = _dl;
+        _dl = NULL;
+        _drawArc_helper(x0, y0, r + 1, filled ? r + 1 : 1, 0, _arcAngle_max, color);
+        _dl = dl;
+        return;
+    }
+    if (!_clipEngine(x0 - r, y0 - r, x0 + r, y0 + r, window)) return;
     
     if (_portrait) swapvals(x0,y0);                                             // X-GRAPH: moved after drawPixel which has its local swaps
     
@@ -1649,20 +2328,20 @@ void XGLCD::_circle_helper(int16_t x0, int16_t y0, int16_t r, uint16_t color, bo
     _TXTrecoverColor = true;
     if (color != _foreColor) setForegroundColor(color);                         // avoid several SPI calls
     
-    _writeRegister(RA8875_DCHR0,    x0 & 0xFF);
-    _writeRegister(RA8875_DCHR0 + 1,x0 >> 8);
+    _queueRegister(RA8875_DCHR0,    x0 & 0xFF);
+    _queueRegister(RA8875_DCHR0 + 1,x0 >> 8);
     
-    _writeRegister(RA8875_DCVR0,    y0 & 0xFF);
-    _writeRegister(RA8875_DCVR0 + 1,y0 >> 8);
-    _writeRegister(RA8875_DCRR,r);
+    _queueRegister(RA8875_DCVR0,    y0 & 0xFF);
+    _queueRegister(RA8875_DCVR0 + 1,y0 >> 8);
+    _queueRegister(RA8875_DCRR,r);
     
+    _flushRegisters();
     writeCommand(RA8875_DCR);
     _spisetSpeed(SPI_SPEED_READ);                                               // Note: the DCR_CIRCLE_START command can only be send at SPI speeds < 10MHz -> X-Graph: 7.5MHz is too high, reduced to 3.75MHz
     filled == true ? _writeData(RA8875_DCR_CIRCLE_START | RA8875_DCR_FILL) : _writeData(RA8875_DCR_CIRCLE_START | RA8875_DCR_NOFILL);
     _spisetSpeed(SPI_SPEED_WRITE);
-    _waitPoll(RA8875_DCR, RA8875_DCR_CIRCLE_STATUS);                            //ZzZzz
-    _waitPoll(RA8875_DCR, RA8875_DCR_CIRCLE_STATUS);                            //ZzZzz: X-Graph: do this twice and clock2 sample draws circle completely, why ?
-    _waitPoll(RA8875_DCR, RA8875_DCR_CIRCLE_STATUS);                            //ZzZzz: X-Graph: do this three times and drawingTests Example works perfectly
+    _waitEngine(RA8875_DCR, RA8875_DCR_CIRCLE_STATUS, 3);                       //ZzZzz: X-Graph: needs 3 'done' reads, else clock2 sample and drawingTests Example do not draw circles completely
+    if (window) _blitEnd();
 }
 
 
@@ -1675,14 +2354,29 @@ void XGLCD::_circle_helper(int16_t x0, int16_t y0, int16_t r, uint16_t color, bo
 
 void XGLCD::_rect_helper(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color, bool filled)
 {
-    if (_portrait) {swapvals(x1,y1); swapvals(x2,y2);}
-    
-    if ((x1 < 0 && x2 < 0) || (x1 >= LCD_WIDTH && x2 >= LCD_WIDTH) ||
-        (y1 < 0 && y2 < 0) || (y1 >= LCD_HEIGHT && y2 >= LCD_HEIGHT))
-        return;                                                                    // All points are out of bounds, don't draw anything
+    uint8_t c;
     
-    _checkLimits_helper(x1,y1);                                                    // Truncate rectangle that is off screen, still draw remaining rectangle
-    _checkLimits_helper(x2,y2);
+    if (_dl) { const int16_t p[] = {x1,y1,x2,y2}; _dl->add(filled ? XG_DL_FILLRECT : XG_DL_RECT, p, 4, color); }
+    c = _clipTest(x1, y1, x2, y2);
+    if (c == XG_CLIP_OUTSIDE) return;                                              // All points are out of bounds, don't draw anything
+    if (c == XG_CLIP_PARTIAL) {
+        if (!filled) {                                                             // The visible parts of the sides
+            XGDisplayList *dl = _dl;
+            _dl = NULL;
+            _rect_helper(x1, y1, x2, y1, color, true);
+            _rect_helper(x1, y2, x2, y2, color, true);
+            _rect_helper(x1, y1, x1, y2, color, true);
+            _rect_helper(x2, y1, x2, y2, color, true);
+            _dl = dl;
+            return;
+        }
+        _clipRect(x1, y1, x2, y2);                                                 // Truncate rectangle, still draw remaining rectangle
+        if (x1 == x2 && y1 == y2) {
+            _pixel_helper(x1, y1, color);
+            return;
+        }
+    }
+    if (_portrait) {swapvals(x1,y1); swapvals(x2,y2);}
     
     if (_textMode) _setTextMode(false);                                            //we are in text mode?
     _TXTrecoverColor = true;
@@ -1690,7 +2384,7 @@ void XGLCD::_rect_helper(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_
     _line_addressing(x1,y1,x2,y2);
     writeCommand(RA8875_DCR);
     filled == true ? _writeData(0xB0) : _writeData(0x90);
-    _waitPoll(RA8875_DCR, RA8875_DCR_LINESQUTRI_STATUS);
+    _waitEngine(RA8875_DCR, RA8875_DCR_LINESQUTRI_STATUS);
 }
 
 
@@ -1703,13 +2397,37 @@ void XGLCD::_rect_helper(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_
 
 void XGLCD::_triangle_helper(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color, bool filled)
 {
-    if (x0 >= _width || x1 >= _width || x2 >= _width) return;
-    if (y0 >= _height || y1 >= _height || y2 >= _height) return;
+    int16_t px[XG_CLIP_POLY] = {x0,x1,x2}, py[XG_CLIP_POLY] = {y0,y1,y2};
+    int16_t xl, yt, xr, yb;
+    uint8_t n, i;
+    bool window;
     
     if (x0 == x1 && y0 == y1 && x0 == x2 && y0 == y2) {                            // X-GRAPH: moved above portrait swap / All points are same
         drawPixel(x0,y0, color);
         return;
     }
+    if (_dl) { const int16_t p[] = {x0,y0,x1,y1,x2,y2}; _dl->add(filled ? XG_DL_FILLTRIANGLE : XG_DL_TRIANGLE, p, 6, color); }
+    
+    xl = x0 < x1 ? (x0 < x2 ? x0 : x2) : (x1 < x2 ? x1 : x2);                      // Bounding box
+    xr = x0 > x1 ? (x0 > x2 ? x0 : x2) : (x1 > x2 ? x1 : x2);
+    yt = y0 < y1 ? (y0 < y2 ? y0 : y2) : (y1 < y2 ? y1 : y2);
+    yb = y0 > y1 ? (y0 > y2 ? y0 : y2) : (y1 > y2 ? y1 : y2);
+    if (xl < 0 || yt < 0 || xr >= _width || yb >= _height) {                       // The engine needs the vertices on the screen
+        if (_clipTest(xl, yt, xr, yb) == XG_CLIP_OUTSIDE) return;
+        XGDisplayList *dl = _dl;
+        _dl = NULL;
+        if (filled) {                                                              // Part on the screen, drawn as a triangle fan
+            n = _clipPolygon(px, py, 3);
+            for (i = 2; i < n; i++) _triangle_helper(px[0], py[0], px[i-1], py[i-1], px[i], py[i], color, true);
+        } else {
+            _line_helper(x0, y0, x1, y1, color);
+            _line_helper(x1, y1, x2, y2, color);
+            _line_helper(x2, y2, x0, y0, color);
+        }
+        _dl = dl;
+        return;
+    }
+    if (!_clipEngine(xl, yt, xr, yb, window)) return;                              // Partly visible: clipped by the active window
     
     if (_portrait) {swapvals(x0,y0); swapvals(x1,y1); swapvals(x2,y2);}
     
@@ -1746,15 +2464,17 @@ void XGLCD::_triangle_helper(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int
     
     _line_addressing(x0,y0,x1,y1);
     
-    _writeRegister(RA8875_DTPH0,    x2 & 0xFF);
-    _writeRegister(RA8875_DTPH0 + 1,x2 >> 8);
-    _writeRegister(RA8875_DTPV0,    y2 & 0xFF);
-    _writeRegister(RA8875_DTPV0 + 1,y2 >> 8);
+    _queueRegister(RA8875_DTPH0,    x2 & 0xFF);
+    _queueRegister(RA8875_DTPH0 + 1,x2 >> 8);
+    _queueRegister(RA8875_DTPV0,    y2 & 0xFF);
+    _queueRegister(RA8875_DTPV0 + 1,y2 >> 8);
     
+    _flushRegisters();
     writeCommand(RA8875_DCR);
     filled == true ? _writeData(0xA1) : _writeData(0x81);
     
-    _waitPoll(RA8875_DCR, RA8875_DCR_LINESQUTRI_STATUS);
+    _waitEngine(RA8875_DCR, RA8875_DCR_LINESQUTRI_STATUS);
+    if (window) _blitEnd();
 }
 
 /******************************************************************************/
@@ -1770,12 +2490,16 @@ void XGLCD::_triangle_helper(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int
 /******************************************************************************/
 void XGLCD::_ellipseCurve_helper(int16_t xCenter, int16_t yCenter, int16_t longAxis, int16_t shortAxis, uint8_t curvePart,uint16_t color, bool filled)
 {
+    bool window;
+    
     _center_helper(xCenter,yCenter);                                            //use CENTER?
     
     if (longAxis == 1 && shortAxis == 1) {                                      // X-GRAPH: moved above _portrait check
         drawPixel(xCenter,yCenter,color);
         return;
     }
+    if (_dl) { const int16_t p[] = {xCenter,yCenter,longAxis,shortAxis,curvePart}; _dl->add(filled ? XG_DL_FILLCURVE : XG_DL_CURVE, p, 5, color); }
+    if (!_clipEngine(xCenter - longAxis, yCenter - shortAxis, xCenter + longAxis, yCenter + shortAxis, window)) return;
     
     if (_portrait) {
         swapvals(xCenter,yCenter);
@@ -1802,7 +2526,8 @@ void XGLCD::_ellipseCurve_helper(int16_t xCenter, int16_t yCenter, int16_t longA
     } else {
         filled == true ? _writeData(0xC0) : _writeData(0x80);
     }
-    _waitPoll(RA8875_ELLIPSE, RA8875_ELLIPSE_STATUS);
+    _waitEngine(RA8875_ELLIPSE, RA8875_ELLIPSE_STATUS);
+    if (window) _blitEnd();
 }
 
 /******************************************************************************/
@@ -1821,6 +2546,10 @@ void XGLCD::_ellipseCurve_helper(int16_t xCenter, int16_t yCenter, int16_t longA
 /******************************************************************************/
 void XGLCD::_roundRect_helper(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t r, uint16_t color, bool filled)
 {
+    bool window;
+    
+    if (_dl) { const int16_t p[] = {x0,y0,x1,y1,r}; _dl->add(filled ? XG_DL_FILLRRECT : XG_DL_RRECT, p, 5, color); }
+    if (!_clipEngine(x0, y0, x1, y1, window)) return;
     
     if (_portrait) {swapvals(x0,y0); swapvals(x1,y1);}
     if (_textMode) _setTextMode(false);
@@ -1831,166 +2560,164 @@ void XGLCD::_roundRect_helper(int16_t x0, int16_t y0, int16_t x1, int16_t y1, in
     
     _line_addressing(x0,y0,x1,y1);
     
-    _writeRegister(RA8875_ELL_A0,    r & 0xFF);
-    _writeRegister(RA8875_ELL_A0 + 1,r >> 8);
-    _writeRegister(RA8875_ELL_B0,    r & 0xFF);
-    _writeRegister(RA8875_ELL_B0 + 1,r >> 8);
+    _queueRegister(RA8875_ELL_A0,    r & 0xFF);
+    _queueRegister(RA8875_ELL_A0 + 1,r >> 8);
+    _queueRegister(RA8875_ELL_B0,    r & 0xFF);
+    _queueRegister(RA8875_ELL_B0 + 1,r >> 8);
     
+    _flushRegisters();
     writeCommand(RA8875_ELLIPSE);
     filled == true ? _writeData(0xE0) : _writeData(0xA0);
-    _waitPoll(RA8875_ELLIPSE, RA8875_DCR_LINESQUTRI_STATUS);
+    _waitEngine(RA8875_ELLIPSE, RA8875_DCR_LINESQUTRI_STATUS);
+    if (window) _blitEnd();
 }
 
 /******************************************************************************/
 /*!
  helper function for draw arcs in degrees
- DrawArc function thanks to Jnmattern and his Arc_2.0 (https://github.com/Jnmattern)
- Adapted for DUE by Marek Buriak https://github.com/marekburiak/ILI9341_Due
- Re-Adapted for this library by sumotoy
+ The ring is rendered line by line: the outer and inner edges are tracked with
+ integer arithmetic, the spans are clipped against the start and end angle
+ half-planes (Q15 direction vectors) and identical spans on consecutive lines
+ are merged into one filled rectangle. Only the lines inside the clip box are
+ rendered, the rectangles are clipped by _rect_helper
  PARAMETERS
  cx: center x
  cy: center y
  radius: the radius of the arc
  thickness:
- start: where arc start in degrees: 0 = North
+ start: where arc start in degrees: 0 = East (drawArc adds the offset)
  end:     where arc end in degrees: rotates clockwise
  color:
  [private]
  */
 /******************************************************************************/
-void XGLCD::_drawArc_helper(uint16_t cx, uint16_t cy, uint16_t radius, uint16_t thickness, float start, float end, uint16_t color) {
+#define XG_ARC_SPANS                4                                           // spans per line: 2 ring parts x 2 angle parts
+#define XG_ARC_INF                  0x7FFF
+
+static int32_t _divFloor(int32_t a, int32_t b)
+{
+    int32_t q = a / b;
+    
+    if ((q * b != a) && ((a < 0) != (b < 0))) q--;
+    return q;
+}
+
+void XGLCD::_drawArc_helper(int16_t cx, int16_t cy, uint16_t radius, uint16_t thickness, float start, float end, uint16_t color) {
     
-    //_center_helper(cx,cy);//use CENTER?
-    int16_t xmin = 65535, xmax = -32767, ymin = 32767, ymax = -32767;
-    float cosStart, sinStart, cosEnd, sinEnd;
-    float r, t;
-    float startAngle, endAngle;
+    int32_t startAngle, endAngle, sweep;                                        // tenths of a degree
+    int32_t cs, ss, ce, se, ro2, ri2, y2, xo, xi, t;
+    int32_t al[2], ah[2], rl[2], rh[2];                                         // angle and ring intervals of the current line
+    int16_t nx1[XG_ARC_SPANS], nx2[XG_ARC_SPANS];                               // spans of the current line
+    int16_t px1[XG_ARC_SPANS], px2[XG_ARC_SPANS], py[XG_ARC_SPANS];             // pending rectangles (top line py)
+    bool keep[XG_ARC_SPANS];
+    uint8_t an, rn, nn, pn, i, j, k;
+    int16_t y, bx1, by1, bx2, by2;
+    int32_t yl, yh;
     
-    startAngle = (start / _arcAngle_max) * 360;                                    // 252
-    endAngle = (end / _arcAngle_max) * 360;                                        // 807
+    if (radius == 0) return;
+    _clipBox(bx1, by1, bx2, by2);                                               // Visible lines only
+    yl = (by1 - cy > 1 - (int32_t)radius) ? by1 - cy : 1 - (int32_t)radius;
+    yh = (by2 - cy < (int32_t)radius - 1) ? by2 - cy : (int32_t)radius - 1;
+    if (yl > yh) return;
+    startAngle = xgDeci((start / _arcAngle_max) * 360);
+    endAngle = xgDeci((end / _arcAngle_max) * 360);
     
-    while (startAngle < 0)   startAngle += 360;
-    while (endAngle < 0)     endAngle += 360;
-    while (startAngle > 360) startAngle -= 360;
-    while (endAngle > 360)   endAngle -= 360;
+    while (startAngle < 0)    startAngle += 3600;
+    while (endAngle < 0)      endAngle += 3600;
+    while (startAngle > 3600) startAngle -= 3600;
+    while (endAngle > 3600)   endAngle -= 3600;
+    sweep = endAngle - startAngle;
+    if (sweep < 0) sweep += 3600;
     
+    cs = xgCosDeci(startAngle);                                                 // Start and end direction, Q15
+    ss = xgSinDeci(startAngle);
+    ce = xgCosDeci(endAngle);
+    se = xgSinDeci(endAngle);
     
-    if (startAngle > endAngle) {
-        _drawArc_helper(cx, cy, radius, thickness, ((startAngle) / (float)360) * _arcAngle_max, _arcAngle_max, color);
-        _drawArc_helper(cx, cy, radius, thickness, 0, ((endAngle) / (float)360) * _arcAngle_max, color);
-    } else {
-        //if (_textMode) _setTextMode(false);//we are in text mode?
-        cosStart = _cosDeg_helper(startAngle);                                  // Calculate bounding box for the arc to be drawn
-        sinStart = _sinDeg_helper(startAngle);
-        cosEnd = _cosDeg_helper(endAngle);
-        sinEnd = _sinDeg_helper(endAngle);
-        
-        r = radius;
-        t = r * cosStart;                                                       // Point 1: radius & startAngle
-        if (t < xmin) xmin = t;
-        if (t > xmax) xmax = t;
-        t = r * sinStart;
-        if (t < ymin) ymin = t;
-        if (t > ymax) ymax = t;
+    t = (thickness < radius) ? radius - thickness : 0;
+    ro2 = (int32_t)radius * radius;
+    ri2 = t * t;
+    xo = 0;
+    xi = t;
+    pn = 0;
+    for (y = yl; y <= yh; y++) {
+        y2 = (int32_t)y * y;
+        while ((xo + 1) * (xo + 1) + y2 < ro2) xo++;                            // Last pixel inside the outer edge
+        while (xo >= 0 && xo * xo + y2 >= ro2) xo--;
+        while (xi * xi + y2 < ri2) xi++;                                        // First pixel on or outside the inner edge
+        while (xi > 0 && (xi - 1) * (xi - 1) + y2 >= ri2) xi--;
         
-        t = r * cosEnd;                                                         // Point 2: radius & endAngle
-        if (t < xmin) xmin = t;
-        if (t > xmax) xmax = t;
-        t = r * sinEnd;
-        if (t < ymin) ymin = t;
-        if (t > ymax) ymax = t;
-        
-        r = radius - thickness;                                                 // Point 3: radius-thickness & startAngle
-        t = r * cosStart;
-        if (t < xmin) xmin = t;
-        if (t > xmax) xmax = t;
-        t = r * sinStart;
-        if (t < ymin) ymin = t;
-        if (t > ymax) ymax = t;
+        rn = 0;                                                                 // Ring: one or two intervals
+        if (xi <= xo) {
+            if (xi == 0) {
+                rl[rn] = -xo; rh[rn++] = xo;
+            } else {
+                rl[rn] = -xo; rh[rn++] = -xi;
+                rl[rn] = xi; rh[rn++] = xo;
+            }
+        }
         
-        t = r * cosEnd;                                                         // Point 4: radius-thickness & endAngle
-        if (t < xmin) xmin = t;
-        if (t > xmax) xmax = t;
-        t = r * sinEnd;
-        if (t < ymin) ymin = t;
-        if (t > ymax) ymax = t;
+        if (sweep >= 3600) {                                                    // Angles: start side (cs*y >= ss*x), end side (se*x >= ce*y)
+            an = 1; al[0] = -XG_ARC_INF; ah[0] = XG_ARC_INF;
+        } else {
+            if (ss > 0)      {al[0] = -XG_ARC_INF; ah[0] = _divFloor(cs * y, ss);}
+            else if (ss < 0) {al[0] = -_divFloor(-cs * y, ss); ah[0] = XG_ARC_INF;}
+            else if (cs * y >= 0) {al[0] = -XG_ARC_INF; ah[0] = XG_ARC_INF;}
+            else             {al[0] = XG_ARC_INF; ah[0] = -XG_ARC_INF;}
+            if (se > 0)      {al[1] = -_divFloor(-ce * y, se); ah[1] = XG_ARC_INF;}
+            else if (se < 0) {al[1] = -XG_ARC_INF; ah[1] = _divFloor(ce * y, se);}
+            else if (ce * y <= 0) {al[1] = -XG_ARC_INF; ah[1] = XG_ARC_INF;}
+            else             {al[1] = XG_ARC_INF; ah[1] = -XG_ARC_INF;}
+            if (sweep <= 1800) {                                                // Both sides
+                an = 1;
+                if (al[1] > al[0]) al[0] = al[1];
+                if (ah[1] < ah[0]) ah[0] = ah[1];
+            } else {                                                            // Either side
+                if (al[1] < al[0]) {swapvals(al[0],al[1]); swapvals(ah[0],ah[1]);}
+                if (al[1] > al[0] && al[0] > ah[0]) {al[0] = al[1]; ah[0] = ah[1]; an = 1;}
+                else if (al[1] > ah[1]) an = 1;
+                else if (al[1] <= ah[0] + 1) {if (ah[1] > ah[0]) ah[0] = ah[1]; an = 1;}
+                else an = 2;
+            }
+        }
         
-        if ((startAngle < 90) && (endAngle > 90)) ymax = radius;                // Corrections if arc crosses X or Y axis
-        if ((startAngle < 180) && (endAngle > 180)) xmin = -radius;
-        if ((startAngle < 270) && (endAngle > 270)) ymin = -radius;
+        nn = 0;                                                                 // Spans = ring AND angles, left to right
+        for (i = 0; i < rn; i++) {
+            for (j = 0; j < an; j++) {
+                int32_t l = (rl[i] > al[j]) ? rl[i] : al[j];
+                int32_t h = (rh[i] < ah[j]) ? rh[i] : ah[j];
+                if (l <= h) {nx1[nn] = l; nx2[nn++] = h;}
+            }
+        }
         
-        float sslope = (float)cosStart / (float)sinStart;                       // Slopes for the two sides of the arc
-        float eslope = (float)cosEnd / (float)sinEnd;
-        if (endAngle == 360) eslope = -1000000;
-        int ir2 = (radius - thickness) * (radius - thickness);
-        int or2 = radius * radius;
-        for (int x = xmin; x <= xmax; x++) {
-            bool y1StartFound = false, y2StartFound = false;
-            bool y1EndFound = false, y2EndSearching = false;
-            int y1s = 0, y1e = 0, y2s = 0;//, y2e = 0;
-            for (int y = ymin; y <= ymax; y++) {
-                int x2 = x * x;
-                int y2 = y * y;
-                
-                if (
-                    (x2 + y2 < or2 && x2 + y2 >= ir2) && (
-                                                          (y > 0 && startAngle < 180 && x <= y * sslope) ||
-                                                          (y < 0 && startAngle > 180 && x >= y * sslope) ||
-                                                          (y < 0 && startAngle <= 180) ||
-                                                          (y == 0 && startAngle <= 180 && x < 0) ||
-                                                          (y == 0 && startAngle == 0 && x > 0)
-                                                          ) && (
-                                                                (y > 0 && endAngle < 180 && x >= y * eslope) ||
-                                                                (y < 0 && endAngle > 180 && x <= y * eslope) ||
-                                                                (y > 0 && endAngle >= 180) ||
-                                                                (y == 0 && endAngle >= 180 && x < 0) ||
-                                                                (y == 0 && startAngle == 0 && x > 0)))
-                {
-                    if (!y1StartFound) {                                        //start of the higher line found
-                        y1StartFound = true;
-                        y1s = y;
-                    } else if (y1EndFound && !y2StartFound) {                   //start of the lower line found
-                        y2StartFound = true;
-                        y2s = y;
-                        y += y1e - y1s - 1;                                        // calculate the most probable end of the lower line (in most cases the length of lower line is equal to length of upper line), in the next loop we will validate if the end of line is really there
-                        if (y > ymax - 1) {                                     // the most probable end of line 2 is beyond ymax so line 2 must be shorter, thus continue with pixel by pixel search
-                            y = y2s;                                            // reset y and continue with pixel by pixel search
-                            y2EndSearching = true;
-                        }
-                    } else if (y2StartFound && !y2EndSearching) {
-                        // we validated that the probable end of the lower line has a pixel, continue with pixel by pixel search, in most cases next loop with confirm the end of lower line as it will not find a valid pixel
-                        y2EndSearching = true;
-                    }
-                } else {
-                    if (y1StartFound && !y1EndFound) {                          //higher line end found
-                        y1EndFound = true;
-                        y1e = y - 1;
-                        drawFastVLine(cx + x, cy + y1s, y - y1s, color);
-                        if (y < 0) {
-                            y = abs(y);                                         // skip the empty middle
-                        }
-                        else
-                            break;
-                    } else if (y2StartFound) {
-                        if (y2EndSearching) {
-                            drawFastVLine(cx + x, cy + y2s, y - y2s, color);    // we found the end of the lower line after pixel by pixel search
-                            y2EndSearching = false;
-                            break;
-                        } else {                                                // the expected end of the lower line is not there so the lower line must be shorter
-                            y = y2s;                                            // put the y back to the lower line start and go pixel by pixel to find the end
-                            y2EndSearching = true;
-                        }
-                    }
-                }
+        for (k = 0; k < nn; k++) keep[k] = false;                               // Extend the pending rectangles or draw them
+        for (i = 0; i < pn; ) {
+            for (k = 0; k < nn; k++) {
+                if (!keep[k] && nx1[k] == px1[i] && nx2[k] == px2[i]) break;
             }
-            if (y1StartFound && !y1EndFound){
-                y1e = ymax;
-                drawFastVLine(cx + x, cy + y1s, y1e - y1s + 1, color);
-            } else if (y2StartFound && y2EndSearching)    {                       // we found start of lower line but we are still searching for the end
-                // which we haven't found in the loop so the last pixel in a column must be the end
-                drawFastVLine(cx + x, cy + y2s, ymax - y2s + 1, color);
+            if (k < nn) {
+                keep[k] = true;
+                i++;
+            } else {
+                _arcSpan_helper(cx + px1[i], cy + py[i], cx + px2[i], cy + y - 1, color);
+                pn--;
+                px1[i] = px1[pn]; px2[i] = px2[pn]; py[i] = py[pn];
             }
         }
+        for (k = 0; k < nn; k++) {
+            if (keep[k]) continue;
+            px1[pn] = nx1[k]; px2[pn] = nx2[k]; py[pn++] = y;
+        }
+    }
+    for (i = 0; i < pn; i++) _arcSpan_helper(cx + px1[i], cy + py[i], cx + px2[i], cy + yh, color);
+}
+
+void XGLCD::_arcSpan_helper(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color)
+{
+    if (x1 == x2 && y1 == y2) {
+        drawPixel(x1, y1, color);
+    } else {
+        _rect_helper(x1, y1, x2, y2, color, true);
     }
 }
 
@@ -2022,20 +2749,21 @@ void XGLCD::_center_helper(int16_t &x, int16_t &y)
  [private]
  */
 /******************************************************************************/
-void XGLCD::_line_addressing(int16_t x0, int16_t y0, int16_t x1, int16_t y1)
+void XGLCD::_line_addressing(int16_t x0, int16_t y0, int16_t x1, int16_t y1, bool flush)
 {
     //X0
-    _writeRegister(RA8875_DLHSR0,    x0 & 0xFF);
-    _writeRegister(RA8875_DLHSR0 + 1,x0 >> 8);
+    _queueRegister(RA8875_DLHSR0,    x0 & 0xFF);
+    _queueRegister(RA8875_DLHSR0 + 1,x0 >> 8);
     //Y0
-    _writeRegister(RA8875_DLVSR0,    y0 & 0xFF);
-    _writeRegister(RA8875_DLVSR0 + 1,y0 >> 8);
+    _queueRegister(RA8875_DLVSR0,    y0 & 0xFF);
+    _queueRegister(RA8875_DLVSR0 + 1,y0 >> 8);
     //X1
-    _writeRegister(RA8875_DLHER0,    x1 & 0xFF);
-    _writeRegister(RA8875_DLHER0 + 1,x1 >> 8);
+    _queueRegister(RA8875_DLHER0,    x1 & 0xFF);
+    _queueRegister(RA8875_DLHER0 + 1,x1 >> 8);
     //Y1
-    _writeRegister(RA8875_DLVER0,    y1 & 0xFF);
-    _writeRegister(RA8875_DLVER0 + 1,y1 >> 8);
+    _queueRegister(RA8875_DLVER0,    y1 & 0xFF);
+    _queueRegister(RA8875_DLVER0 + 1,y1 >> 8);
+    if (flush) _flushRegisters();
 }
 
 /******************************************************************************/
@@ -2047,15 +2775,16 @@ void XGLCD::_line_addressing(int16_t x0, int16_t y0, int16_t x1, int16_t y1)
 void XGLCD::_curve_addressing(int16_t x0, int16_t y0, int16_t x1, int16_t y1)
 {
     //center
-    _writeRegister(RA8875_DEHR0,    x0 & 0xFF);
-    _writeRegister(RA8875_DEHR0 + 1,x0 >> 8);
-    _writeRegister(RA8875_DEVR0,    y0 & 0xFF);
-    _writeRegister(RA8875_DEVR0 + 1,y0 >> 8);
+    _queueRegister(RA8875_DEHR0,    x0 & 0xFF);
+    _queueRegister(RA8875_DEHR0 + 1,x0 >> 8);
+    _queueRegister(RA8875_DEVR0,    y0 & 0xFF);
+    _queueRegister(RA8875_DEVR0 + 1,y0 >> 8);
     //long,short ax
-    _writeRegister(RA8875_ELL_A0,    x1 & 0xFF);
-    _writeRegister(RA8875_ELL_A0 + 1,x1 >> 8);
-    _writeRegister(RA8875_ELL_B0,    y1 & 0xFF);
-    _writeRegister(RA8875_ELL_B0 + 1,y1 >> 8);
+    _queueRegister(RA8875_ELL_A0,    x1 & 0xFF);
+    _queueRegister(RA8875_ELL_A0 + 1,x1 >> 8);
+    _queueRegister(RA8875_ELL_B0,    y1 & 0xFF);
+    _queueRegister(RA8875_ELL_B0 + 1,y1 >> 8);
+    _flushRegisters();
 }
 
 /******************************************************************************/
@@ -2066,14 +2795,12 @@ void XGLCD::_curve_addressing(int16_t x0, int16_t y0, int16_t x1, int16_t y1)
 /******************************************************************************/
 float XGLCD::_cosDeg_helper(float angle)
 {
-    float radians = angle / (float)360 * 2 * PI;
-    return cos(radians);
+    return xgCosDeci(xgDeci(angle)) / (float)XG_Q15_ONE;
 }
 
 float XGLCD::_sinDeg_helper(float angle)
 {
-    float radians = angle / (float)360 * 2 * PI;
-    return sin(radians);
+    return xgSinDeci(xgDeci(angle)) / (float)XG_Q15_ONE;
 }
 
 
@@ -2117,10 +2844,12 @@ seperate GUI file.
  backSegColor: the color of the segments not active (default BLACK)
  angle:        90 -> 180 (the shape of the meter, 90:halfway, 180:full round, 150:default)
  inc:             5...20 (5:solid, 20:sparse divisions, default:10)
+ NOTE: redraws all segments, use XGRingMeter for a meter that is updated often
  */
 /******************************************************************************/
 void XGLCD::ringMeter(int val, int minV, int maxV, int16_t x, int16_t y, uint16_t r, const char* units, uint16_t colorScheme,uint16_t backSegColor,int16_t angle,uint8_t inc)
 {
+    _XGP_SCOPE;
     if (inc < 5) inc = 5;
     if (inc > 20) inc = 20;
     if (r < 50) r = 50;
@@ -2133,61 +2862,22 @@ void XGLCD::ringMeter(int val, int minV, int maxV, int16_t x, int16_t y, uint16_
     uint16_t w = r / 4;                                                         // Width of outer ring is 1/4 of radius
     const uint8_t seg = 5;                                                      // Segments are 5 degrees wide = 60 segments for 300 degrees
     for (int16_t i = -angle; i < angle; i += inc) {                             // Draw colour blocks every inc degrees
-        colour = COLOR_BLACK;
-        switch (colorScheme) {
-            case 0:
-                colour = COLOR_RED;
-                break;
-            case 1:
-                colour = COLOR_GREEN;
-                break;
-            case 2:
-                colour = COLOR_BLUE;
-                break;
-            case 3:
-                colour = gradient(map(i, -angle, angle, 0, 127));               // Full spectrum blue to red
-                break;
-            case 4:
-                colour = gradient(map(i, -angle, angle, 63, 127));              // Green to red (high temperature etc)
-                break;
-            case 5:
-                colour = gradient(map(i, -angle, angle, 127, 63));              // Red to green (low battery etc)
-                break;
-            case 6:
-                colour = gradient(map(i, -angle, angle, 127, 0));               // Red to blue (air cond reverse)
-                break;
-            case 7:
-                colour = gradient(map(i, -angle, angle, 35, 127));              // cyan to red
-                break;
-            case 8:
-                colour = colorInterpolation(0,0,0,255,255,255,map(i,-angle,angle,0,w),w); // black to white
-                break;
-            case 9:
-                colour = colorInterpolation(0x80,0,0xC0,0xFF,0xFF,0,map(i,-angle,angle,0,w),w); // violet to yellow
-                break;
-            default:
-                if (colorScheme > 9){
-                    colour = colorScheme;
-                } else {
-                    colour = COLOR_BLUE;
-                }
-                break;
-        }
+        colour = _ringMeterColor(i, angle, colorScheme, w);
         
-        float xStart = cos((i - 90) * 0.0174532925);                            // Calculate pair of coordinates for segment start
-        float yStart = sin((i - 90) * 0.0174532925);
-        uint16_t x0 = xStart * (r - w) + x;
-        uint16_t y0 = yStart * (r - w) + y;
-        uint16_t x1 = xStart * r + x;
-        uint16_t y1 = yStart * r + y;
+        int16_t xStart = xgCosDeg(i - 90);                                      // Calculate pair of coordinates for segment start
+        int16_t yStart = xgSinDeg(i - 90);
+        uint16_t x0 = xgMulQ15(r - w, xStart) + x;
+        uint16_t y0 = xgMulQ15(r - w, yStart) + y;
+        uint16_t x1 = xgMulQ15(r, xStart) + x;
+        uint16_t y1 = xgMulQ15(r, yStart) + y;
         
         
-        float xEnd = cos((i + seg - 90) * 0.0174532925);                        // Calculate pair of coordinates for segment end
-        float yEnd = sin((i + seg - 90) * 0.0174532925);
-        int16_t x2 = xEnd * (r - w) + x;
-        int16_t y2 = yEnd * (r - w) + y;
-        int16_t x3 = xEnd * r + x;
-        int16_t y3 = yEnd * r + y;
+        int16_t xEnd = xgCosDeg(i + seg - 90);                                  // Calculate pair of coordinates for segment end
+        int16_t yEnd = xgSinDeg(i + seg - 90);
+        int16_t x2 = xgMulQ15(r - w, xEnd) + x;
+        int16_t y2 = xgMulQ15(r - w, yEnd) + y;
+        int16_t x3 = xgMulQ15(r, xEnd) + x;
+        int16_t y3 = xgMulQ15(r, yEnd) + y;
         
         if (i < curAngle) {                                                     // Fill in coloured segments with 2 triangles
             fillQuad(x0, y0, x1, y1, x2, y2, x3, y3, colour, false);
@@ -2221,49 +2911,1332 @@ void XGLCD::ringMeter(int val, int minV, int maxV, int16_t x, int16_t y, uint16_
     //return x + r;                                                             // Calculate and return right hand side x coordinate
 }
 
+/******************************************************************************/
+/*!
+ Color of the ringMeter segment at angle i (-angle .. angle)
+ w: interpolation steps of the schemes 8 and 9 (ring width, r/4)
+ [private]
+ */
+/******************************************************************************/
+uint16_t XGLCD::_ringMeterColor(int16_t i, int16_t angle, uint16_t colorScheme, uint16_t w)
+{
+    uint16_t colour;
+    
+    switch (colorScheme) {
+        case 0:
+            colour = COLOR_RED;
+            break;
+        case 1:
+            colour = COLOR_GREEN;
+            break;
+        case 2:
+            colour = COLOR_BLUE;
+            break;
+        case 3:
+            colour = gradient(map(i, -angle, angle, 0, 127));                   // Full spectrum blue to red
+            break;
+        case 4:
+            colour = gradient(map(i, -angle, angle, 63, 127));                  // Green to red (high temperature etc)
+            break;
+        case 5:
+            colour = gradient(map(i, -angle, angle, 127, 63));                  // Red to green (low battery etc)
+            break;
+        case 6:
+            colour = gradient(map(i, -angle, angle, 127, 0));                   // Red to blue (air cond reverse)
+            break;
+        case 7:
+            colour = gradient(map(i, -angle, angle, 35, 127));                  // cyan to red
+            break;
+        case 8:
+            colour = colorInterpolation(0,0,0,255,255,255,map(i,-angle,angle,0,w),w); // black to white
+            break;
+        case 9:
+            colour = colorInterpolation(0x80,0,0xC0,0xFF,0xFF,0,map(i,-angle,angle,0,w),w); // violet to yellow
+            break;
+        default:
+            if (colorScheme > 9){
+                colour = colorScheme;
+            } else {
+                colour = COLOR_BLUE;
+            }
+            break;
+    }
+    return colour;
+}
+
 void XGLCD::roundGaugeTicker(uint16_t x, uint16_t y, uint16_t r, int from, int to, float dev,uint16_t color)
 {
-    float dsec;
+    _XGP_SCOPE;
+    int16_t ri = r / dev, c, s;
     int i;
     for (i = from; i <= to; i += 30) {
-        dsec = i * (PI / 180);
+        c = xgCosDeg(i);
+        s = xgSinDeg(i);
         drawLine(
-                 x + (cos(dsec) * (r / dev)) + 1,
-                 y + (sin(dsec) * (r / dev)) + 1,
-                 x + (cos(dsec) * r) + 1,
-                 y + (sin(dsec) * r) + 1,
+                 x + xgMulQ15(ri, c) + 1,
+                 y + xgMulQ15(ri, s) + 1,
+                 x + xgMulQ15(r, c) + 1,
+                 y + xgMulQ15(r, s) + 1,
                  color);
     }
 }
 
+/******************************************************************************/
+/*!
+ Draw a scaled image
+ Parameters:
+ x,y: top left position on the screen
+ width,height: size of the image
+ image: RGB565 pixels, 2 bytes per pixel, high byte first
+ scale: size in percent (100 = original size, 200 = double, 50 = half)
+ NOTE:
+ The image is clipped like blit (screen and clip rectangle) and streamed as
+ one memory write burst, the active window is restored afterwards.
+ Nearest neighbour, see drawBitmapSmooth for bilinear interpolation.
+ */
+/******************************************************************************/
 void XGLCD::drawBitmap(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t * image, uint16_t scale) {
-    // To be implemented
+    _XGP_SCOPE;
+    if (scale == 0) return;
+    _bitmapTransform(x, y, width, height, image, 0, scale / 100.0f, 0, 0, false);
 }
+
+/******************************************************************************/
+/*!
+ Draw a scaled image with bilinear interpolation
+ Parameters: see drawBitmap(x, y, width, height, image, scale)
+ */
+/******************************************************************************/
+void XGLCD::drawBitmapSmooth(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t * image, uint16_t scale) {
+    _XGP_SCOPE;
+    if (scale == 0) return;
+    _bitmapTransform(x, y, width, height, image, 0, scale / 100.0f, 0, 0, true);
+}
+
+/******************************************************************************/
+/*!
+ Draw a rotated image, for needles, compass roses...
+ Parameters:
+ x,y: top left position of the image when it is not rotated
+ width,height: size of the image
+ image: RGB565 pixels, 2 bytes per pixel, high byte first
+ degree: clockwise rotation (0-359)
+ rx,ry: rotation center in the image, this point stays at x+rx,y+ry
+ NOTE:
+ Only the pixels inside the rotated image are written (one burst per line),
+ the background around it is not touched. Clipped like blit.
+ Nearest neighbour, see drawBitmapSmooth for bilinear interpolation.
+ */
+/******************************************************************************/
 void XGLCD::drawBitmap(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t * image, uint16_t degree, uint16_t rx, uint16_t ry) {
-    // To be implemented (rotation version)
+    _XGP_SCOPE;
+    _bitmapTransform(x + rx, y + ry, width, height, image, degree % 360, 1.0f, rx, ry, false);
+}
+
+/******************************************************************************/
+/*!
+ Draw a rotated image with bilinear interpolation
+ Parameters: see drawBitmap(x, y, width, height, image, degree, rx, ry)
+ */
+/******************************************************************************/
+void XGLCD::drawBitmapSmooth(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t * image, uint16_t degree, uint16_t rx, uint16_t ry) {
+    _XGP_SCOPE;
+    _bitmapTransform(x + rx, y + ry, width, height, image, degree % 360, 1.0f, rx, ry, true);
+}
+
+/******************************************************************************/
+/*!
+ Scanline blitter for the scaled and rotated drawBitmap
+ [private]
+ Every screen pixel of the bounding box is mapped back into the image with
+ 16.16 fixed point coordinates that are updated incrementally, along a line
+ and from line to line.
+ Parameters:
+ x,y: screen position of the image point rx,ry
+ width,height,image: see drawBitmap
+ angle: clockwise rotation in degrees
+ scale: size factor
+ rx,ry: image point at x,y
+ smooth: bilinear interpolation
+ */
+/******************************************************************************/
+#define XG_XFORM_CHUNK              64                                          // pixels per write, the stream continues in the next chunk
+
+void XGLCD::_bitmapTransform(int16_t x, int16_t y, uint16_t width, uint16_t height, const uint8_t *image, float angle, float scale, float rx, float ry, bool smooth)
+{
+    uint16_t buf[XG_XFORM_CHUNK];
+    float c = _cosDeg_helper(angle), s = _sinDeg_helper(angle);
+    float px, py, minX = 0, maxX = 0, minY = 0, maxY = 0;
+    int32_t a, b, u, v, u0, v0, w32 = (int32_t)width << 16, h32 = (int32_t)height << 16;
+    int16_t bx, by, bw, bh, row, col;
+    uint32_t offset;
+    uint16_t n;
+    bool inside;
+    uint8_t i;
+    
+    if (width == 0 || height == 0) return;
+    if (angle == 0) {c = 1; s = 0;}                                             // Exact for the plain scale
+    for (i = 0; i < 4; i++) {                                                   // Bounding box of the transformed corners
+        px = ((i & 1) ? width : 0) - rx;
+        py = ((i & 2) ? height : 0) - ry;
+        float dx = (px * c - py * s) * scale;
+        float dy = (px * s + py * c) * scale;
+        if (i == 0 || dx < minX) minX = dx;
+        if (i == 0 || dx > maxX) maxX = dx;
+        if (i == 0 || dy < minY) minY = dy;
+        if (i == 0 || dy > maxY) maxY = dy;
+    }
+    bx = x + (int16_t)floor(minX + 0.5f); bw = (int16_t)floor(maxX + 0.5f) - (int16_t)floor(minX + 0.5f);
+    by = y + (int16_t)floor(minY + 0.5f); bh = (int16_t)floor(maxY + 0.5f) - (int16_t)floor(minY + 0.5f);
+    if (!_blitBegin(bx, by, bw, bh, offset, bw)) return;
+    
+    a = (int32_t)(c / scale * 65536.0f);                                        // Inverse transform: screen step -> image step
+    b = (int32_t)(s / scale * 65536.0f);
+    px = bx - x + 0.5f;                                                         // First pixel center relative to x,y
+    py = by - y + 0.5f;
+    u0 = (int32_t)((rx + (px * c + py * s) / scale) * 65536.0f);
+    v0 = (int32_t)((ry + (py * c - px * s) / scale) * 65536.0f);
+    for (row = by; row < by + bh; row++, u0 += b, v0 += a) {                    // Next line: one screen step down
+        u = u0;
+        v = v0;
+        n = 0;
+        inside = false;
+        for (col = bx; col < bx + bw; col++, u += a, v -= b) {
+            if (u < 0 || v < 0 || u >= w32 || v >= h32) {
+                if (inside) break;                                              // The image is convex: the line is done
+                continue;
+            }
+            if (!inside) {                                                      // First pixel of this line
+                inside = true;
+                setXY(col, row);
+                writeCommand(RA8875_MRWC);
+            }
+            buf[n++] = _bitmapSample(image, width, height, u, v, smooth);
+            if (n == XG_XFORM_CHUNK) {
+                _writePixels16(buf, n);
+                n = 0;
+            }
+        }
+        if (n) _writePixels16(buf, n);
+    }
+    _blitEnd();
+}
+
+/******************************************************************************/
+/*!
+ Read an image pixel at 16.16 fixed point position u,v (inside the image)
+ [private]
+ */
+/******************************************************************************/
+uint16_t XGLCD::_bitmapSample(const uint8_t *image, uint16_t width, uint16_t height, int32_t u, int32_t v, bool smooth)
+{
+    const uint8_t *p;
+    uint32_t x0, y0, x1, y1, fx, fy, w[4], r = 0, g = 0, bl = 0, k;
+    uint16_t cl;
+    
+    if (!smooth) {
+        p = image + (((uint32_t)(v >> 16) * width + (u >> 16)) << 1);
+        return (p[0] << 8) | p[1];
+    }
+    u -= 0x8000; v -= 0x8000;                                                   // Interpolate between pixel centers
+    if (u < 0) u = 0;
+    if (v < 0) v = 0;
+    x0 = u >> 16; y0 = v >> 16;
+    fx = (u >> 8) & 0xFF; fy = (v >> 8) & 0xFF;
+    x1 = (x0 + 1 < width) ? x0 + 1 : x0;
+    y1 = (y0 + 1 < height) ? y0 + 1 : y0;
+    w[0] = (256 - fx) * (256 - fy); w[1] = fx * (256 - fy);
+    w[2] = (256 - fx) * fy;         w[3] = fx * fy;
+    for (k = 0; k < 4; k++) {
+        p = image + ((((k & 2) ? y1 : y0) * width + ((k & 1) ? x1 : x0)) << 1);
+        cl = (p[0] << 8) | p[1];
+        r += (cl >> 11) * w[k];
+        g += ((cl >> 5) & 0x3F) * w[k];
+        bl += (cl & 0x1F) * w[k];
+    }
+    return (((r + 0x8000) >> 16) << 11) | (((g + 0x8000) >> 16) << 5) | ((bl + 0x8000) >> 16);
 }
 
-// drawBitmap only supports 16-bit color and rotation=0 (for littlevgl support) to speed up things
+// drawBitmap only supports 16-bit color (for littlevgl support) to speed up things, in portrait mode the
+// pixels are streamed top-down (see setRotation)
 // if (_textMode) _setTextMode(false); is not added, not supported for textmode is needed for LittleVGL anyhow
+// the visible part (screen, clip rectangle) is drawn in a temporary active window, as blit
 
 void XGLCD::drawBitmap(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t * image) {
-    uint32_t count;
-
-    uint32_t i;
-    i = (uint32_t)image;
+    _XGP_SCOPE;
+    int16_t x = x1, y = y1, w = x2 - x1 + 1, h = y2 - y1 + 1;
+    uint16_t stride = x2 - x1 + 1;
+    uint32_t offset, count, n;
+    uint16_t *p;
     
-    setActiveWindow(x1,x2,y1,y2);
-    setXY(x1,y1);
-    count = (x2 - x1 + 1) * (y2 - y1 + 1);
-    writeCommand(RA8875_MRWC);
-    _spiCSLow;
+    if (_dl) {                                                                  // record as one op, then draw unrecorded
+        XGDisplayList *dl = _dl;
+        const int16_t p[] = {(int16_t)x1,(int16_t)y1,(int16_t)x2,(int16_t)y2};
+        dl->addBitmap(p, image);
+        _dl = NULL;
+        drawBitmap(x1, y1, x2, y2, image);
+        _dl = dl;
+        return;
+    }
+    if (!_blitBegin(x, y, w, h, offset, stride)) return;
+    image += offset;
+    count = w;
+    if (w == stride) {                                                          // Complete lines: one stream
+        count *= h;
+        h = 1;
+    }
+    for (; h > 0; h--, image += stride) {
+        p = image;
+        n = count;                                                              // _spixwritedma changes n and p
+        _spiCSLow;
 #ifdef _spixwritedma
-    _spixwritedma(RA8875_DATAWRITE, image, count);
+        _spixwritedma(RA8875_DATAWRITE, p, n);
 #else
-    _spiwrite(RA8875_DATAWRITE);
-    _spiwritedma(image, count);
+        _spiwrite(RA8875_DATAWRITE);
+        _spiwritedma(p, n);
 #endif
-    _spiCSHigh;
+        _spiCSHigh;
+    }
+    _blitEnd();
+}
+
+/******************************************************************************/
+/*!
+ Draw a 8 bit (RGB332) image, 1 byte per pixel
+ Parameters:
+ x1,y1,x2,y2: area to fill (inclusive)
+ image: RGB332 pixels, see Color565To332
+ NOTE:
+ see drawPixels8, drawn as blit: clipped, the active window is left
+ unchanged and nothing is recorded in a display list
+ */
+/******************************************************************************/
+void XGLCD::drawBitmap8(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, const uint8_t * image) {
+    _XGP_SCOPE;
+    blit(x1, y1, x2 - x1 + 1, y2 - y1 + 1, image);
+}
+
+/******************************************************************************/
+/*!
+ Copy a rectangle of pixels to the screen, clipped to the screen and the
+ clip rectangle (setClipRect)
+ Parameters:
+ x,y: top left position on the screen, may be outside the screen
+ w,h: size of the source rectangle
+ src: RGB565 pixels (same as drawPixels) or RGB332 pixels (see drawPixels8)
+ stride: pixels per source line (0 = w), to blit a part of a larger image
+ NOTE:
+ Works in all rotations and color depths. The visible part is written as
+ one stream in a temporary active window, the active window is restored
+ afterwards. Not recorded in display lists.
+ */
+/******************************************************************************/
+void XGLCD::blit(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t * src, uint16_t stride)
+{
+    _XGP_SCOPE;
+    uint32_t offset;
+    
+    if (stride == 0) stride = w;
+    if (!_blitBegin(x, y, w, h, offset, stride)) return;
+    src += offset;
+    if (w == stride) {
+        _writePixels16(src, (uint32_t)w * h);
+    } else {
+        while (h--) {
+            _writePixels16(src, w);
+            src += stride;
+        }
+    }
+    _blitEnd();
+}
+
+void XGLCD::blit(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t * src, uint16_t stride)
+{
+    _XGP_SCOPE;
+    uint32_t offset;
+    
+    if (stride == 0) stride = w;
+    if (!_blitBegin(x, y, w, h, offset, stride)) return;
+    src += offset;
+    if (w == stride) {
+        _writePixels8(src, (uint32_t)w * h);
+    } else {
+        while (h--) {
+            _writePixels8(src, w);
+            src += stride;
+        }
+    }
+    _blitEnd();
+}
+
+/******************************************************************************/
+/*!
+ Limit drawing to a rectangle of the screen
+ Parameters:
+ x1,y1,x2,y2: clip rectangle (inclusive), in the current rotation
+ NOTE:
+ Clipped: pixels, lines, rectangles, triangles, quads, polygons, circles,
+ ellipses, curves, rounded rectangles, arcs, fillWindow, text in the library
+ fonts, blits and bitmaps. Not clipped: text in the RA8875 ROM font,
+ clearScreen and the BTE functions (copy, pattern, layer operations).
+ Replaces the current clip rectangle, the saved ones (pushClipRect) are kept.
+ */
+/******************************************************************************/
+void XGLCD::setClipRect(int16_t x1, int16_t y1, int16_t x2, int16_t y2)
+{
+    _XGP_SCOPE;
+    if (x1 > x2) swapvals(x1,x2);
+    if (y1 > y2) swapvals(y1,y2);
+    _clipX1 = x1; _clipY1 = y1;
+    _clipX2 = x2; _clipY2 = y2;
+    _clipOn = true;
+    _recordClip();
+}
+
+/******************************************************************************/
+/*!
+ Remove the clip rectangle and all saved ones (pushClipRect)
+ */
+/******************************************************************************/
+void XGLCD::clearClipRect(void)
+{
+    _XGP_SCOPE;
+    _clipOn = false;
+    _clipDepth = 0;
+    _recordClip();
+}
+
+/******************************************************************************/
+/*!
+ Save the clip rectangle and clip to the part of it inside a new rectangle
+ Parameters:
+ x1,y1,x2,y2: rectangle (inclusive), in the current rotation
+ NOTE:
+ popClipRect restores the saved clip rectangle. Up to XG_CLIP_STACK levels
+ are saved, deeper levels still clip but their pop keeps the current one.
+ */
+/******************************************************************************/
+void XGLCD::pushClipRect(int16_t x1, int16_t y1, int16_t x2, int16_t y2)
+{
+    _XGP_SCOPE;
+    if (x1 > x2) swapvals(x1,x2);
+    if (y1 > y2) swapvals(y1,y2);
+    if (_clipDepth < XG_CLIP_STACK) {
+        int16_t *c = _clipStack[_clipDepth];
+        c[0] = _clipX1; c[1] = _clipY1;
+        c[2] = _clipX2; c[3] = _clipY2;
+        c[4] = _clipOn;
+    }
+    if (_clipDepth < 255) _clipDepth++;
+    if (_clipOn) {                                                              // Intersection, can be empty
+        if (_clipX1 > x1) x1 = _clipX1;
+        if (_clipY1 > y1) y1 = _clipY1;
+        if (_clipX2 < x2) x2 = _clipX2;
+        if (_clipY2 < y2) y2 = _clipY2;
+    }
+    _clipX1 = x1; _clipY1 = y1;
+    _clipX2 = x2; _clipY2 = y2;
+    _clipOn = true;
+    _recordClip();
+}
+
+void XGLCD::popClipRect(void)
+{
+    _XGP_SCOPE;
+    if (_clipDepth == 0) return;
+    _clipDepth--;
+    if (_clipDepth < XG_CLIP_STACK) {
+        const int16_t *c = _clipStack[_clipDepth];
+        _clipX1 = c[0]; _clipY1 = c[1];
+        _clipX2 = c[2]; _clipY2 = c[3];
+        _clipOn = c[4];
+        _recordClip();
+    }
+}
+
+/******************************************************************************/
+/*!
+ Record the clip rectangle in effect in the display list (beginRecording)
+ [private]
+ */
+/******************************************************************************/
+void XGLCD::_recordClip(void)
+{
+    if (!_dl) return;
+    if (_clipOn) {
+        const int16_t p[] = {_clipX1, _clipY1, _clipX2, _clipY2};
+        _dl->add(XG_DL_CLIP, p, 4);
+    } else {
+        _dl->add(XG_DL_CLIPOFF, NULL, 0);
+    }
+}
+
+/******************************************************************************/
+/*!
+ The visible area: the screen, limited by the clip rectangle
+ [private]
+ Parameters:
+ x1,y1,x2,y2: returns the area (inclusive), x1 > x2 or y1 > y2 when empty
+ */
+/******************************************************************************/
+void XGLCD::_clipBox(int16_t &x1, int16_t &y1, int16_t &x2, int16_t &y2)
+{
+    x1 = 0; y1 = 0;
+    x2 = _width - 1; y2 = _height - 1;
+    if (_clipOn) {
+        if (_clipX1 > x1) x1 = _clipX1;
+        if (_clipY1 > y1) y1 = _clipY1;
+        if (_clipX2 < x2) x2 = _clipX2;
+        if (_clipY2 < y2) y2 = _clipY2;
+    }
+}
+
+/******************************************************************************/
+/*!
+ Test a rectangle against the visible area (_clipBox)
+ [private]
+ Parameters:
+ x1,y1,x2,y2: rectangle (inclusive), the corners can be in any order
+ Returns XG_CLIP_OUTSIDE, XG_CLIP_PARTIAL or XG_CLIP_INSIDE
+ */
+/******************************************************************************/
+uint8_t XGLCD::_clipTest(int16_t x1, int16_t y1, int16_t x2, int16_t y2)
+{
+    int16_t cx1, cy1, cx2, cy2;
+    
+    if (x1 > x2) swapvals(x1,x2);
+    if (y1 > y2) swapvals(y1,y2);
+    _clipBox(cx1, cy1, cx2, cy2);
+    if (cx1 > cx2 || cy1 > cy2) return XG_CLIP_OUTSIDE;
+    if (x2 < cx1 || x1 > cx2 || y2 < cy1 || y1 > cy2) return XG_CLIP_OUTSIDE;
+    if (x1 >= cx1 && x2 <= cx2 && y1 >= cy1 && y2 <= cy2) return XG_CLIP_INSIDE;
+    return XG_CLIP_PARTIAL;
+}
+
+/******************************************************************************/
+/*!
+ Clip a rectangle to the visible area
+ [private]
+ Parameters:
+ x1,y1,x2,y2: rectangle (inclusive), sorted and clipped on return
+ Returns false if nothing is visible
+ */
+/******************************************************************************/
+bool XGLCD::_clipRect(int16_t &x1, int16_t &y1, int16_t &x2, int16_t &y2)
+{
+    int16_t cx1, cy1, cx2, cy2;
+    
+    if (x1 > x2) swapvals(x1,x2);
+    if (y1 > y2) swapvals(y1,y2);
+    _clipBox(cx1, cy1, cx2, cy2);
+    if (x1 < cx1) x1 = cx1;
+    if (y1 < cy1) y1 = cy1;
+    if (x2 > cx2) x2 = cx2;
+    if (y2 > cy2) y2 = cy2;
+    return (x1 <= x2 && y1 <= y2);
+}
+
+/******************************************************************************/
+/*!
+ Clip a run of pixels (drawPixels) to one line of the visible area
+ [private]
+ Parameters:
+ x,y: start of the run, x returns the first visible pixel
+ count: number of pixels, returns the visible pixels
+ skip: returns the number of pixels before the first visible one
+ Returns false if nothing is visible
+ NOTE:
+ Without a clip rectangle a run that starts on the screen is not changed,
+ it continues on the next line of the active window (hardware)
+ */
+/******************************************************************************/
+bool XGLCD::_clipRun(int16_t &x, int16_t y, uint32_t &count, uint32_t &skip)
+{
+    int16_t cx1, cy1, cx2, cy2;
+    
+    skip = 0;
+    if (count == 0) return false;
+    if (!_clipOn && x >= 0 && y >= 0 && x < _width && y < _height) return true;
+    _clipBox(cx1, cy1, cx2, cy2);
+    if (y < cy1 || y > cy2 || x > cx2 || cx1 > cx2) return false;
+    if (x < cx1) {
+        if ((uint32_t)(cx1 - x) >= count) return false;
+        skip = cx1 - x;
+        count -= skip;
+        x = cx1;
+    }
+    if (count > (uint32_t)(cx2 - x + 1)) count = cx2 - x + 1;
+    return true;
+}
+
+/******************************************************************************/
+/*!
+ Clip a line to the screen (Cohen-Sutherland)
+ [private]
+ Parameters:
+ x0,y0,x1,y1: end points, clipped on return
+ Returns false if the line is not on the screen
+ NOTE:
+ The crossings are calculated on the original line and rounded. The engine
+ draws the part on the screen with its own slope, which can differ by a pixel
+ from the complete line. The clip rectangle is not used here: it is applied
+ with the active window (_clipEngine), so the same pixels are drawn with and
+ without a clip rectangle.
+ */
+/******************************************************************************/
+#define XG_CLIP_LEFT                0x01                                        // Cohen-Sutherland outcodes
+#define XG_CLIP_RIGHT               0x02
+#define XG_CLIP_TOP                 0x04
+#define XG_CLIP_BOTTOM              0x08
+
+static uint8_t _outCode(int32_t x, int32_t y, int16_t cx1, int16_t cy1, int16_t cx2, int16_t cy2)
+{
+    uint8_t c = 0;
+    
+    if (x < cx1) c |= XG_CLIP_LEFT;
+    else if (x > cx2) c |= XG_CLIP_RIGHT;
+    if (y < cy1) c |= XG_CLIP_TOP;
+    else if (y > cy2) c |= XG_CLIP_BOTTOM;
+    return c;
+}
+
+// a / b rounded to the nearest integer (halves away from zero)
+static int32_t _divRound(int64_t a, int32_t b)
+{
+    if (b < 0) {a = -a; b = -b;}
+    return (a >= 0) ? (int32_t)((a + b / 2) / b) : -(int32_t)((-a + b / 2) / b);
+}
+
+bool XGLCD::_clipLine(int16_t &x0, int16_t &y0, int16_t &x1, int16_t &y1)
+{
+    int16_t cx1, cy1, cx2, cy2;
+    int32_t ax = x0, ay = y0, bx = x1, by = y1, dx = bx - ax, dy = by - ay, x, y;
+    uint8_t c0, c1, c;
+    
+    cx1 = 0; cy1 = 0;
+    cx2 = _width - 1; cy2 = _height - 1;
+    c0 = _outCode(ax, ay, cx1, cy1, cx2, cy2);
+    c1 = _outCode(bx, by, cx1, cy1, cx2, cy2);
+    while (c0 | c1) {
+        if (c0 & c1) return false;                                              // Both end points outside the same edge
+        c = c0 ? c0 : c1;
+        if (c & (XG_CLIP_TOP | XG_CLIP_BOTTOM)) {
+            y = (c & XG_CLIP_TOP) ? cy1 : cy2;
+            x = x0 + _divRound((int64_t)dx * (y - y0), dy);
+        } else {
+            x = (c & XG_CLIP_LEFT) ? cx1 : cx2;
+            y = y0 + _divRound((int64_t)dy * (x - x0), dx);
+        }
+        if (c == c0) {
+            ax = x; ay = y;
+            c0 = _outCode(ax, ay, cx1, cy1, cx2, cy2);
+        } else {
+            bx = x; by = y;
+            c1 = _outCode(bx, by, cx1, cy1, cx2, cy2);
+        }
+    }
+    x0 = ax; y0 = ay;
+    x1 = bx; y1 = by;
+    return true;
+}
+
+/******************************************************************************/
+/*!
+ Clip a convex polygon to the screen (Sutherland-Hodgman)
+ [private]
+ Parameters:
+ x,y: vertices, room for XG_CLIP_POLY, the clipped polygon on return
+ n: number of vertices, 4 or less
+ Returns the number of vertices of the clipped polygon (0 = not on the screen)
+ NOTE:
+ As _clipLine, the clip rectangle is applied later with the active window
+ */
+/******************************************************************************/
+uint8_t XGLCD::_clipPolygon(int16_t *x, int16_t *y, uint8_t n)
+{
+    int16_t tx[XG_CLIP_POLY], ty[XG_CLIP_POLY], c[4];
+    int32_t px, py, qx, qy, v;
+    uint8_t e, i, m;
+    bool pin, qin;
+    
+    c[0] = 0; c[1] = 0;                                                         // Edges: left, top, right, bottom
+    c[2] = _width - 1; c[3] = _height - 1;
+    for (e = 0; e < 4 && n > 0; e++) {
+        for (i = 0; i < n; i++) {tx[i] = x[i]; ty[i] = y[i];}
+        v = c[e];
+        px = tx[n - 1]; py = ty[n - 1];
+        pin = (e == 0) ? px >= v : (e == 1) ? py >= v : (e == 2) ? px <= v : py <= v;
+        for (i = 0, m = 0; i < n; i++) {
+            qx = tx[i]; qy = ty[i];
+            qin = (e == 0) ? qx >= v : (e == 1) ? qy >= v : (e == 2) ? qx <= v : qy <= v;
+            if (qin != pin) {                                                   // The edge is crossed
+                if (e & 1) {
+                    x[m] = px + _divRound((int64_t)(qx - px) * (v - py), qy - py);
+                    y[m++] = v;
+                } else {
+                    x[m] = v;
+                    y[m++] = py + _divRound((int64_t)(qy - py) * (v - px), qx - px);
+                }
+            }
+            if (qin) {x[m] = qx; y[m++] = qy;}
+            px = qx; py = qy; pin = qin;
+        }
+        n = m;
+    }
+    return n;
+}
+
+/******************************************************************************/
+/*!
+ Clip a shape that is drawn by the RA8875 engine in one go (circle, ellipse,
+ rounded rectangle, fillWindow)
+ [private]
+ Parameters:
+ x1,y1,x2,y2: bounding box of the shape
+ window: returns true when the active window is set to the visible area,
+ restore it with _blitEnd when the engine is started
+ Returns false if nothing is visible
+ NOTE:
+ The engines only write inside the active window, so a shape that crosses the
+ edge of the clip rectangle is clipped by the RA8875 itself
+ */
+/******************************************************************************/
+bool XGLCD::_clipEngine(int16_t x1, int16_t y1, int16_t x2, int16_t y2, bool &window)
+{
+    int16_t cx1, cy1, cx2, cy2, wx1, wy1, wx2, wy2;
+    uint8_t c = _clipTest(x1, y1, x2, y2);
+    
+    window = (c == XG_CLIP_PARTIAL && _clipOn);
+    if (window) {
+        _clipBox(cx1, cy1, cx2, cy2);
+        if (_portrait) {                                                        // Keep the active window limits
+            wx1 = _activeWindowYT; wx2 = _activeWindowYB;
+            wy1 = _activeWindowXL; wy2 = _activeWindowXR;
+        } else {
+            wx1 = _activeWindowXL; wx2 = _activeWindowXR;
+            wy1 = _activeWindowYT; wy2 = _activeWindowYB;
+        }
+        if (wx1 > cx1) cx1 = wx1;
+        if (wy1 > cy1) cy1 = wy1;
+        if (wx2 < cx2) cx2 = wx2;
+        if (wy2 < cy2) cy2 = wy2;
+        if (cx1 > cx2 || cy1 > cy2) return false;
+        _setTempWindow(cx1, cy1, cx2 - cx1 + 1, cy2 - cy1 + 1);
+    }
+    return c != XG_CLIP_OUTSIDE;
+}
+
+/******************************************************************************/
+/*!
+ Clip a blit and prepare the RA8875 for the pixel stream
+ [private]
+ Parameters:
+ x,y,w,h: destination rectangle, clipped on return
+ offset: returns the offset (in pixels) of the first visible source pixel
+ stride: pixels per source line
+ Returns false if nothing is visible
+ */
+/******************************************************************************/
+bool XGLCD::_blitBegin(int16_t &x, int16_t &y, int16_t &w, int16_t &h, uint32_t &offset, uint16_t stride)
+{
+    if (!_clipBlit(x, y, w, h, offset, stride)) return false;
+    _setTempWindow(x, y, w, h);
+    setXY(x,y);
+    writeCommand(RA8875_MRWC);
+    return true;
+}
+
+/******************************************************************************/
+/*!
+ Clip a rectangle to the screen and the clip rectangle
+ [private]
+ Parameters: see _blitBegin
+ Returns false if nothing is visible
+ */
+/******************************************************************************/
+bool XGLCD::_clipBlit(int16_t &x, int16_t &y, int16_t &w, int16_t &h, uint32_t &offset, uint16_t stride)
+{
+    int32_t x1 = x, y1 = y, x2 = (int32_t)x + w - 1, y2 = (int32_t)y + h - 1;
+    int16_t cx1, cy1, cx2, cy2;
+    
+    _clipBox(cx1, cy1, cx2, cy2);
+    if (x1 < cx1) x1 = cx1;
+    if (y1 < cy1) y1 = cy1;
+    if (x2 > cx2) x2 = cx2;
+    if (y2 > cy2) y2 = cy2;
+    if (w <= 0 || h <= 0 || x1 > x2 || y1 > y2) return false;
+    offset = (uint32_t)(y1 - y) * stride + (x1 - x);
+    x = x1; y = y1;
+    w = x2 - x1 + 1; h = y2 - y1 + 1;
+    return true;
+}
+
+/******************************************************************************/
+/*!
+ Set the active window to a rectangle, restore the previous one with _blitEnd
+ [private]
+ Parameters:
+ x,y,w,h: rectangle in (rotated) screen coordinates, must be on the screen
+ */
+/******************************************************************************/
+void XGLCD::_setTempWindow(int16_t x, int16_t y, int16_t w, int16_t h)
+{
+    if (_textMode) _setTextMode(false);                                         //we are in text mode?
+    _blitWindow[0] = _activeWindowXL; _blitWindow[1] = _activeWindowXR;
+    _blitWindow[2] = _activeWindowYT; _blitWindow[3] = _activeWindowYB;
+    if (_portrait) {                                                            // Same as setActiveWindow, without recording
+        _activeWindowXL = y; _activeWindowXR = y + h - 1;
+        _activeWindowYT = x; _activeWindowYB = x + w - 1;
+    } else {
+        _activeWindowXL = x; _activeWindowXR = x + w - 1;
+        _activeWindowYT = y; _activeWindowYB = y + h - 1;
+    }
+    _updateActiveWindow(false);
+}
+
+void XGLCD::_blitEnd(void)
+{
+    _activeWindowXL = _blitWindow[0]; _activeWindowXR = _blitWindow[1];
+    _activeWindowYT = _blitWindow[2]; _activeWindowYB = _blitWindow[3];
+    _updateActiveWindow(false);
+}
+
+/******************************************************************************/
+/*!
+ Draw a run length encoded image, made with extras/tools/xg_rle.py
+ Parameters:
+ x,y: top left position
+ rle: encoded image
+ FORMAT:
+ 'X','R', width and height (16 bit little endian), followed by packets:
+ 0x00-0x7F: c+1 literal pixels follow
+ 0x80-0xFE: one pixel follows, repeated (c & 0x7F)+1 times
+ 0xFF: 16 bit little endian count and one pixel follow (long run)
+ Pixels are RGB565, high byte first. Runs continue on the next line.
+ NOTE:
+ Runs of XG_RLE_ENGINE_MIN or more visible pixels (a run over several lines
+ becomes one rectangle) are filled by the rectangle engine, all other pixels
+ are streamed. Clipped like blit, not recorded in a display list.
+ */
+/******************************************************************************/
+#define XG_RLE_ENGINE_MIN           24                                          // below this a run is cheaper to stream than to set up the engine for
+#define XG_RLE_CHUNK                32                                          // literal pixels converted at a time
+
+void XGLCD::drawRLE(int16_t x, int16_t y, const uint8_t * rle)
+{
+    _XGP_SCOPE;
+    XGDisplayList *dl = _dl;
+    uint16_t buf[XG_RLE_CHUNK];
+    const uint8_t *p = rle + 6, *lit;
+    int16_t w, h, bx = x, by = y, bw, bh, cx1, cx2, cy1, cy2;
+    int32_t row, col, a, b, rowEnd, extra, next;
+    uint32_t offset, pos = 0, total, n, len, i, k;
+    uint16_t color = 0;
+    uint8_t c;
+    
+    if (rle[0] != 'X' || rle[1] != 'R') return;
+    w = rle[2] | (rle[3] << 8);
+    h = rle[4] | (rle[5] << 8);
+    bw = w; bh = h;
+    if (!_blitBegin(bx, by, bw, bh, offset, w)) return;
+    cx1 = bx - x; cx2 = cx1 + bw - 1;                                           // Visible part in image coordinates
+    cy1 = by - y; cy2 = cy1 + bh - 1;
+    next = (int32_t)cy1 * w + cx1;                                              // Image position of the memory write cursor, -1 = unknown
+    total = (uint32_t)w * h;
+    _dl = NULL;
+    
+    while (pos < total) {
+        c = *p++;
+        if (c < 0x80) {
+            n = c + 1;
+            lit = p;
+            p += n * 2;
+        } else {
+            if (c == 0xFF) {
+                n = p[0] | (p[1] << 8);
+                p += 2;
+            } else {
+                n = (c & 0x7F) + 1;
+            }
+            color = (p[0] << 8) | p[1];
+            p += 2;
+            lit = NULL;
+        }
+        if (n > total - pos) n = total - pos;
+        
+        while (n) {                                                             // One line at a time
+            row = pos / w;
+            col = pos % w;
+            len = w - col;
+            if (len > n) len = n;
+            a = (col > cx1) ? col : cx1;                                        // Visible part of this line
+            b = (col + (int32_t)len - 1 < cx2) ? col + len - 1 : cx2;
+            if (row < cy1 || row > cy2 || a > b) {
+                if (lit) lit += len * 2;
+            } else if (lit == NULL) {
+                rowEnd = row;
+                if (a == cx1 && b == cx2) {                                     // Following lines that are fully covered
+                    extra = (n - len) / w;
+                    if ((int32_t)((n - len) % w) > cx2) extra++;
+                    rowEnd = (row + extra < cy2) ? row + extra : cy2;
+                }
+                if ((b - a + 1) * (rowEnd - row + 1) >= XG_RLE_ENGINE_MIN) {
+                    _rect_helper(x + a, y + row, x + b, y + rowEnd, color, true);
+                    next = -1;
+                    len = (uint32_t)(rowEnd - row + 1) * w - col;
+                    if (len > n) len = n;
+                } else {
+                    if (next != row * w + a) {
+                        setXY(x + a, y + row);
+                        writeCommand(RA8875_MRWC);
+                    }
+                    pushPixels(b - a + 1, color);
+                    next = (b == cx2) ? (row + 1) * w + cx1 : row * w + b + 1;
+                }
+            } else {
+                if (next != row * w + a) {
+                    setXY(x + a, y + row);
+                    writeCommand(RA8875_MRWC);
+                }
+                for (i = a - col; i <= (uint32_t)(b - col); i += k) {
+                    k = b - col + 1 - i;
+                    if (k > XG_RLE_CHUNK) k = XG_RLE_CHUNK;
+                    for (uint32_t j = 0; j < k; j++) buf[j] = (lit[(i + j) * 2] << 8) | lit[(i + j) * 2 + 1];
+                    _writePixels16(buf, k);
+                }
+                next = (b == cx2) ? (row + 1) * w + cx1 : row * w + b + 1;
+                lit += len * 2;
+            }
+            pos += len;
+            n -= len;
+        }
+    }
+    _dl = dl;
+    _blitEnd();
+}
+
+/******************************************************************************/
+/*!
+ Draw a palette image (1, 2, 4 or 8 bits per pixel)
+ Parameters:
+ x,y: top left position
+ image: size, palette and packed indices (see tIndexedImage)
+ NOTE:
+ The palette is converted once to a lookup table for the color depth (RGB565
+ or RGB332), indices without a palette entry are black. Every line is
+ expanded in a staging buffer and streamed, the visible part is one memory
+ write burst in a temporary active window. Clipped like blit, not recorded
+ in a display list.
+ */
+/******************************************************************************/
+#define XG_INDEXED_CHUNK            128                                         // pixels expanded at a time
+
+void XGLCD::drawIndexed(int16_t x, int16_t y, const tIndexedImage &image)
+{
+    _XGP_SCOPE;
+    uint16_t lut[256];
+    uint16_t buf[XG_INDEXED_CHUNK];
+    uint8_t *buf8 = (uint8_t *)buf;
+    const uint8_t *line;
+    uint8_t bits = image.bits, mask = (1 << bits) - 1;
+    uint16_t colors = image.colors, i, n, k;
+    uint32_t offset, lineBytes = ((uint32_t)image.width * bits + 7) >> 3, bit;
+    int16_t bx = x, by = y, w = image.width, h = image.height, col;
+    bool bpp16 = (_color_bpp > 8);
+    
+    if (bits != 1 && bits != 2 && bits != 4 && bits != 8) return;
+    if (!_blitBegin(bx, by, w, h, offset, image.width)) return;
+    if (colors == 0 || colors > (1 << bits)) colors = 1 << bits;
+    for (i = 0; i < (1 << bits); i++) {
+        if (i >= colors) lut[i] = 0;
+        else lut[i] = bpp16 ? image.palette[i] : Color565To332(image.palette[i]);
+    }
+    
+    line = image.data + (uint32_t)(by - y) * lineBytes;
+    while (h--) {
+        for (col = 0; col < w; col += n) {
+            n = (w - col < XG_INDEXED_CHUNK) ? w - col : XG_INDEXED_CHUNK;
+            bit = (uint32_t)(bx - x + col) * bits;
+            for (k = 0; k < n; k++, bit += bits) {
+                i = (line[bit >> 3] >> (8 - bits - (bit & 7))) & mask;
+                if (bpp16) buf[k] = lut[i]; else buf8[k] = lut[i];
+            }
+            if (bpp16) _writePixels16(buf, n); else _writePixels8(buf8, n);
+        }
+        line += lineBytes;
+    }
+    _blitEnd();
+}
+
+/******************************************************************************/
+/*!
+ Draw a monochrome bitmap (icon, mask, glyph) with the BTE color expansion:
+ the bitmap is send as is, 1 bit per pixel on the bus
+ Parameters:
+ x,y: top left position
+ w,h: size in pixels
+ bits: every line starts on a byte boundary, the first pixel is bit 7
+ fg: color of the 1 bits
+ bg: color of the 0 bits
+ transparent: the 0 bits are not drawn
+ NOTE:
+ Clipped like blit, a clipped left edge uses the start bit of the expansion.
+ Not recorded in a display list.
+ In portrait mode the bits are transposed on the fly (the BTE expands along
+ the memory lines). Changes the foreground and background colors.
+ */
+/******************************************************************************/
+#define XG_MONO_CHUNK               64                                          // bytes send at a time
+
+void XGLCD::drawMono(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t * bits, uint16_t fg, uint16_t bg, bool transparent)
+{
+    _XGP_SCOPE;
+    uint16_t stage[XG_MONO_CHUNK / 2];                                          // 16 bit aligned for the bulk writes
+    uint8_t *buf = (uint8_t *)stage;
+    uint32_t lineBytes = ((uint32_t)w + 7) >> 3, n = 0, offset;
+    int16_t bx = x, by = y, bw = w, bh = h, i, j, c, r;
+    uint8_t start, acc, k;
+    const uint8_t *src;
+    
+    if (w <= 0 || h <= 0) return;
+    if (!_clipBlit(bx, by, bw, bh, offset, w)) return;
+    if (fg != _foreColor) setForegroundColor(fg);
+    if (bg != _backColor) setBackgroundColor(bg);
+    _TXTrecoverColor = true;
+    
+    c = bx - x;                                                                 // First visible pixel in the bitmap
+    r = by - y;
+    start = _portrait ? 7 : 7 - (c & 7);
+    _bteMcuBegin(bx, by, bw, bh, (start << 4) | (transparent ? 0x09 : 0x08));  // Color expansion with MCU data, ROP = start bit
+    
+    if (!_portrait) {
+        for (j = 0; j < bh; j++) {                                              // Each line starts with a new byte at the start bit
+            src = bits + (uint32_t)(r + j) * lineBytes + (c >> 3);
+            for (k = 0; k < (((c & 7) + bw + 7) >> 3); k++) {
+                buf[n++] = *src++;
+                if (n == XG_MONO_CHUNK) {_writeBytes(buf, n); n = 0;}
+            }
+        }
+    } else {
+        for (i = 0; i < bw; i++) {                                              // Memory line = bitmap column
+            src = bits + (uint32_t)r * lineBytes + ((c + i) >> 3);
+            k = 7 - ((c + i) & 7);
+            acc = 0;
+            for (j = 0; j < bh; j++, src += lineBytes) {
+                acc = (acc << 1) | ((*src >> k) & 1);
+                if ((j & 7) == 7 || j == bh - 1) {
+                    buf[n++] = acc << (7 - (j & 7));
+                    acc = 0;
+                    if (n == XG_MONO_CHUNK) {_writeBytes(buf, n); n = 0;}
+                }
+            }
+        }
+    }
+    if (n) _writeBytes(buf, n);
+    _waitEngine(RA8875_BECR0, 0x40);
+}
+
+/******************************************************************************/
+/*!
+ Draw an image with a transparent (chroma key) color, the BTE skips the
+ pixels with the key color so the background is never read back
+ Parameters:
+ x,y: top left position
+ w,h: size of the source rectangle
+ image: RGB565 pixels (same as blit)
+ key: transparent color
+ stride: pixels per source line (0 = w)
+ NOTE:
+ The BTE compares with the foreground color register (the transparent color of
+ setTransparentColor is only used by the floating window), the foreground color
+ is changed. At 8 bpp the key is compared after the conversion to RGB332.
+ In portrait mode the pixels are send column by column (the BTE writes along
+ the memory lines). Clipped like blit, not recorded in a display list.
+ */
+/******************************************************************************/
+#define XG_KEYED_CHUNK              64                                          // portrait: pixels gathered at a time
+
+void XGLCD::drawBitmapKeyed(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t * image, uint16_t key, uint16_t stride)
+{
+    _XGP_SCOPE;
+    uint16_t buf[XG_KEYED_CHUNK];
+    uint32_t offset;
+    const uint16_t *src;
+    int16_t i, j, n;
+    
+    if (stride == 0) stride = w;
+    if (!_clipBlit(x, y, w, h, offset, stride)) return;
+    if (key != _foreColor) setForegroundColor(key);
+    _TXTrecoverColor = true;
+    _bteMcuBegin(x, y, w, h, RA8875_BTEROP_SOURCE | 0x04);                      // Transparent write with MCU data
+    image += offset;
+    if (!_portrait) {
+        for (j = 0; j < h; j++, image += stride) _writePixels16(image, w);
+    } else {
+        for (i = 0; i < w; i++) {                                               // Memory line = image column
+            src = image + i;
+            for (j = 0; j < h; j += n) {
+                n = (h - j < XG_KEYED_CHUNK) ? h - j : XG_KEYED_CHUNK;
+                for (int16_t k = 0; k < n; k++, src += stride) buf[k] = *src;
+                _writePixels16(buf, n);
+            }
+        }
+    }
+    _waitEngine(RA8875_BECR0, 0x40);
+}
+
+/******************************************************************************/
+/*!
+ Start a BTE that takes its data from the MCU (through MRWC)
+ [private]
+ Parameters:
+ x,y,w,h: destination (on the screen), in the current layer
+ becr1: ROP (or start bit) and operation
+ */
+/******************************************************************************/
+void XGLCD::_bteMcuBegin(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t becr1)
+{
+    if (_textMode) _setTextMode(false);                                         //we are in text mode?
+    if (!_useInt) _waitBusy(0x40);                                              // Another BTE still in progress?
+    if (_portrait) {swapvals(x,y); swapvals(w,h);}
+    if (_useMultiLayers && _currentLayer == 1) y |= 0x8000;                     // Destination layer 2
+    _queueRegister(RA8875_HDBE0, x & 0xFF);
+    _queueRegister(RA8875_HDBE0+1, x >> 8);
+    _queueRegister(RA8875_VDBE0, y & 0xFF);
+    _queueRegister(RA8875_VDBE0+1, y >> 8);
+    _queueRegister(RA8875_BEWR0, w & 0xFF);
+    _queueRegister(RA8875_BEWR0+1, w >> 8);
+    _queueRegister(RA8875_BEHR0, h & 0xFF);
+    _queueRegister(RA8875_BEHR0+1, h >> 8);
+    _queueRegister(RA8875_BECR1, becr1);
+    _flushRegisters();
+    _writeRegister(RA8875_BECR0, 0x80);                                         // Start, the BTE waits for the data
+    writeCommand(RA8875_MRWC);
+}
+
+/******************************************************************************/
+/*!
+ Same as drawBitmap, but returns as soon as the DMA transfer is started
+ Parameters:
+ x1,y1,x2,y2: area to fill (inclusive)
+ image: 16 bit pixels, must stay valid until the transfer is finished
+ callback: called (from interrupt context!) when the transfer is finished
+ Every other library call first waits for the transfer to finish, use
+ isBusy() to check or waitIdle() to wait.
+ On CPU's without asynchronous DMA support this falls back to drawBitmap
+ and calls the callback before returning.
+ */
+/******************************************************************************/
+void XGLCD::drawBitmapAsync(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t * image, void (*callback)(void)) {
+    _XGP_SCOPE;
+#if defined(XG_CPU_ESP32)
+    uint32_t count;
+    
+    if (dmaIntr == NULL || _dl || _clipTest(x1, y1, x2, y2) != XG_CLIP_INSIDE) { // No interrupt available, recording or clipped: blocking transfer
+        drawBitmap(x1, y1, x2, y2, image);
+        if (callback) callback();
+        return;
+    }
+    setActiveWindow(x1,x2,y1,y2);
+    setXY(x1,y1);
+    count = (x2 - x1 + 1) * (y2 - y1 + 1);
+    writeCommand(RA8875_MRWC);
+    _dmaCmd = RA8875_DATAWRITE;
+    _dmaCallback = callback;
+    _dmaBusy = true;
+    dev->slave.trans_done = 0;
+    dev->slave.trans_inten = 1;
+    _spixstartdma(&_dmaCmd, image, count);
+#elif defined(XG_CPU_MKR) && !defined(XG_MKR_NO_DMA)
+    uint32_t count;
+    
+    count = (x2 - x1 + 1) * (y2 - y1 + 1);
+    if (count*2 > (uint32_t)XG_DMAC_CHAIN * XG_DMAC_MAX_BLOCK || _dl ||       // Too large for one descriptor chain, recording or clipped: blocking transfer
+        _clipTest(x1, y1, x2, y2) != XG_CLIP_INSIDE) {
+        drawBitmap(x1, y1, x2, y2, image);
+        if (callback) callback();
+        return;
+    }
+    setActiveWindow(x1,x2,y1,y2);
+    setXY(x1,y1);
+    writeCommand(RA8875_MRWC);
+    _dmaCallback = callback;
+    _dmaBusy = true;
+    _spiCSLow;                                                                  // CS is released by XG_DMAC_Handler()
+    _spiwrite(RA8875_DATAWRITE);
+    _dmacStart((const uint8_t *)image, count*2, true);
+#else
+    drawBitmap(x1, y1, x2, y2, image);
+    if (callback) callback();
+#endif
+}
+
+/******************************************************************************/
+/*!
+ Returns true while an asynchronous transfer (drawBitmapAsync) is running
+ or a pipelined hardware command (usePipeline) may still be running
+ */
+/******************************************************************************/
+bool XGLCD::isBusy(void) {
+    _XGP_SCOPE;
+    return _dmaBusy || _pendReg;
+}
+
+/******************************************************************************/
+/*!
+ Wait until an asynchronous transfer (drawBitmapAsync) and a pipelined
+ hardware command (usePipeline) are finished
+ */
+/******************************************************************************/
+void XGLCD::waitIdle(void) {
+    _XGP_SCOPE;
+    while (_dmaBusy);
+    _syncEngine();
+}
+
+#if defined(XG_CPU_ESP32)
+/******************************************************************************/
+/*! PRIVATE
+ SPI transfer done interrupt, only enabled during drawBitmapAsync
+ */
+/******************************************************************************/
+void IRAM_ATTR XGLCD::_dmaDoneISR(void *arg) {
+    XGLCD *lcd = (XGLCD *)arg;
+    void (*cb)(void);
+    
+    if (!lcd->dev->slave.trans_done) return;
+    lcd->dev->slave.trans_done = 0;
+    lcd->dev->slave.trans_inten = 0;
+    cb = lcd->_dmaCallback;
+    lcd->_dmaCallback = NULL;
+    lcd->_dmaBusy = false;
+    if (cb) cb();                                                               // May start the next transfer
+}
+#endif
+
+/*
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
++								DISPLAY LISTS						           +
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+Static screen parts (gauge faces, grids, labels) can be recorded once in a
+XGDisplayList and redrawn with drawList() without recalculating them.
+See XGDisplayList.h for an example.
+ */
+
+/******************************************************************************/
+/*!
+ Start recording in a display list, all drawing primitives, text, bitmaps,
+ window and clip rectangle changes are added to dl while they are drawn as
+ usual
+ Parameters:
+ dl: the list to record in, new ops are appended to the ops already in it
+ */
+/******************************************************************************/
+void XGLCD::beginRecording(XGDisplayList *dl)
+{
+    _XGP_SCOPE;
+    _dl = dl;
+    if (_clipOn) _recordClip();                                                 // Replay with the clip the ops are drawn with now
+}
+
+/******************************************************************************/
+/*!
+ Stop recording, check dl->overflow() to see if everything was recorded
+ */
+/******************************************************************************/
+void XGLCD::endRecording(void)
+{
+    _XGP_SCOPE;
+    _dl = NULL;
+}
+
+/******************************************************************************/
+/*!
+ Redraw everything recorded in a display list
+ Parameters:
+ dl: the list to draw, call dl.optimize() once after recording for fewer commands
+ NOTE:
+ While recording, the ops of dl are recorded in the current list.
+ The recorded clip rectangles are limited to the clip rectangle in effect
+ when drawList is called, which is restored afterwards.
+ */
+/******************************************************************************/
+void XGLCD::drawList(const XGDisplayList &dl)
+{
+    _XGP_SCOPE;
+    const uint8_t *op = dl.data();
+    const uint8_t *end = op + dl.length();
+    uint16_t color = _foreColor;
+    int16_t p[6];
+    uint8_t i, n;
+    bool clipOn = _clipOn;                                                      // Clip rectangle of the caller
+    int16_t clip[4] = {_clipX1, _clipY1, _clipX2, _clipY2};
+    
+    if (_dl == &dl) return;                                                     // would record in the list being drawn
+    
+    while (op < end) {
+        n = XGDisplayList::params(op[0]);
+        for (i = 0; i < n; i++) p[i] = XGDisplayList::get16(op + 1 + (i * 2));
+        switch (op[0]) {
+            case XG_DL_COLOR:       color = p[0]; break;
+            case XG_DL_WINDOW:      setActiveWindow(p[0], p[1], p[2], p[3]); break;
+            case XG_DL_WINDOWFULL:  setActiveWindow(); break;
+            case XG_DL_CLIP:
+                if (clipOn) {                                                   // Intersection, can be empty
+                    if (clip[0] > p[0]) p[0] = clip[0];
+                    if (clip[1] > p[1]) p[1] = clip[1];
+                    if (clip[2] < p[2]) p[2] = clip[2];
+                    if (clip[3] < p[3]) p[3] = clip[3];
+                }
+                _clipX1 = p[0]; _clipY1 = p[1];
+                _clipX2 = p[2]; _clipY2 = p[3];
+                _clipOn = true;
+                _recordClip();
+                break;
+            case XG_DL_CLIPOFF:
+                _clipX1 = clip[0]; _clipY1 = clip[1];
+                _clipX2 = clip[2]; _clipY2 = clip[3];
+                _clipOn = clipOn;
+                _recordClip();
+                break;
+            case XG_DL_FILLWIN:     fillWindow(color); break;
+            case XG_DL_PIXEL:       drawPixel(p[0], p[1], color); break;
+            case XG_DL_LINE:        drawLine(p[0], p[1], p[2], p[3], color); break;
+            case XG_DL_RECT:
+            case XG_DL_FILLRECT:    _rect_helper(p[0], p[1], p[2], p[3], color, op[0] & 1); break;
+            case XG_DL_RRECT:
+            case XG_DL_FILLRRECT:   _roundRect_helper(p[0], p[1], p[2], p[3], p[4], color, op[0] & 1); break;
+            case XG_DL_CIRCLE:
+            case XG_DL_FILLCIRCLE:  _circle_helper(p[0], p[1], p[2], color, op[0] & 1); break;
+            case XG_DL_TRIANGLE:
+            case XG_DL_FILLTRIANGLE: _triangle_helper(p[0], p[1], p[2], p[3], p[4], p[5], color, op[0] & 1); break;
+            case XG_DL_CURVE:
+            case XG_DL_FILLCURVE:   _ellipseCurve_helper(p[0], p[1], p[2], p[3], p[4], color, op[0] & 1); break;
+            case XG_DL_BITMAP:
+                drawBitmap(p[0], p[1], p[2], p[3], (uint16_t *)XGDisplayList::getBitmap(op));
+                break;
+            case XG_DL_TEXT:
+                _cursorX = p[0];
+                _cursorY = p[1];
+                _TXTForeColor = p[2];
+                _TXTBackColor = p[3];
+                _TXTrecoverColor = true;                                        // _textWrite restores the text colors
+                _absoluteCenter = p[4] & XG_DL_TEXT_ABSCENTER;
+                _relativeCenter = p[4] & XG_DL_TEXT_RELCENTER;
+                _TXTAlignXToCenter = p[4] & XG_DL_TEXT_ALIGNX;
+                _TXTAlignYToCenter = p[4] & XG_DL_TEXT_ALIGNY;
+                if (!_absoluteCenter && !_relativeCenter) _textPosition(_cursorX, _cursorY, false);
+                _textWrite((const char *)op + 13, p[5]);
+                break;
+        }
+        op += XGDisplayList::opSize(op);
+    }
+    if (_clipOn != clipOn || _clipX1 != clip[0] || _clipY1 != clip[1] || _clipX2 != clip[2] || _clipY2 != clip[3]) {
+        _clipX1 = clip[0]; _clipY1 = clip[1];
+        _clipX2 = clip[2]; _clipY2 = clip[3];
+        _clipOn = clipOn;
+        _recordClip();
+    }
 }
 
 /*
@@ -2299,7 +4272,6 @@ The RA8875 also supports a hardware cursor, blinking or not. This is usefull
 void XGLCD::_setTextMode(bool m)
 {
     if (m == _textMode) return;
-    writeCommand(RA8875_MWCR0);
     if (m){
         _MWCR0_Reg |= RA8875_MWCR0_TXTMODE;
         _textMode = true;
@@ -2307,7 +4279,7 @@ void XGLCD::_setTextMode(bool m)
         _MWCR0_Reg &= ~RA8875_MWCR0_TXTMODE;
         _textMode = false;
     }
-    _writeData(_MWCR0_Reg);
+    _writeRegister(RA8875_MWCR0, _MWCR0_Reg);
 }
 
 /******************************************************************************/
@@ -2319,6 +4291,7 @@ void XGLCD::_setTextMode(bool m)
 /******************************************************************************/
 void XGLCD::uploadUserChar(const uint8_t symbol[],uint8_t address)
 {
+    _XGP_SCOPE;
 	uint8_t tempMWCR1 = _readRegister(RA8875_MWCR1);
 	uint8_t i;
 	if (_textMode) _setTextMode(false);
@@ -2342,6 +4315,7 @@ void XGLCD::uploadUserChar(const uint8_t symbol[],uint8_t address)
 /******************************************************************************/
 void XGLCD::showUserChar(uint8_t symbolAddrs,uint8_t wide)
 {
+    _XGP_SCOPE;
 	if (!_textMode) _setTextMode(true);
 	uint8_t oldReg1State = _FNCR0_Reg;
 	uint8_t oldReg2State = 0;
@@ -2385,6 +4359,7 @@ void XGLCD::showUserChar(uint8_t symbolAddrs,uint8_t wide)
 /******************************************************************************/
 void XGLCD::setIntFontCoding(enum RA8875fontCoding f)
 {
+    _XGP_SCOPE;
 	uint8_t temp = _FNCR0_Reg;
 	temp &= ~(RA8875_FNCR0_8859_MASK);
     switch (f){
@@ -2414,6 +4389,7 @@ void XGLCD::setIntFontCoding(enum RA8875fontCoding f)
 /******************************************************************************/
 void XGLCD::setFont(void)
 {
+    _XGP_SCOPE;
 	if (!_textMode) _setTextMode(true);
 	_TXTrender      = false;
     _FNTwidth 		= 	8;
@@ -2439,6 +4415,7 @@ void XGLCD::setFont(void)
 
 void XGLCD::setFont(const tFont *font)
 {
+    _XGP_SCOPE;
 	_currentFont = font;
 	_FNTheight = 		_currentFont->font_height;
 	_FNTwidth = 		_currentFont->font_width;                               //if 0 it's variable width font
@@ -2471,6 +4448,7 @@ void XGLCD::setFont(const tFont *font)
 /******************************************************************************/
 void XGLCD::setFontFullAlign(boolean align)
 {
+    _XGP_SCOPE;
 	if (!_TXTrender){
 		align == true ? _FNCR1_Reg |= RA8875_FNCR1_ALIGNMENT_ON : _FNCR1_Reg &= ~RA8875_FNCR1_ALIGNMENT_ON;
 		_writeRegister(RA8875_FNCR1,_FNCR1_Reg);
@@ -2487,6 +4465,7 @@ void XGLCD::setFontFullAlign(boolean align)
 /******************************************************************************/
 void XGLCD::setFontInterline(uint8_t pix)
 {
+    _XGP_SCOPE;
 	if (_TXTrender){
 		_FNTinterline = pix;
 	} else {
@@ -2512,6 +4491,7 @@ void XGLCD::setFontInterline(uint8_t pix)
 /******************************************************************************/
 void XGLCD::setCursor(int16_t x, int16_t y,bool autocenter)
 {
+    _XGP_SCOPE;
 	if (x < 0) x = 0;
 	if (y < 0) y = 0;
 	
@@ -2576,10 +4556,11 @@ void XGLCD::setCursor(int16_t x, int16_t y,bool autocenter)
 /******************************************************************************/
 void XGLCD::_textPosition(int16_t x, int16_t y,bool update)
 {
-    _writeRegister(RA8875_F_CURXL,(x & 0xFF));
-	_writeRegister(RA8875_F_CURXH,(x >> 8));
-	_writeRegister(RA8875_F_CURYL,(y & 0xFF));
-	_writeRegister(RA8875_F_CURYH,(y >> 8));
+    _queueRegister(RA8875_F_CURXL,(x & 0xFF));
+	_queueRegister(RA8875_F_CURXH,(x >> 8));
+	_queueRegister(RA8875_F_CURYL,(y & 0xFF));
+	_queueRegister(RA8875_F_CURYH,(y >> 8));
+    _flushRegisters();
     if (update){ _cursorX = x; _cursorY = y;}
 }
 
@@ -2595,6 +4576,7 @@ void XGLCD::_textPosition(int16_t x, int16_t y,bool update)
 /******************************************************************************/
 void XGLCD::getCursor(int16_t &x, int16_t &y)
 {
+    _XGP_SCOPE;
 	if (_TXTrender) {
 		getCursorFast(x,y);
 	} else {
@@ -2621,6 +4603,7 @@ void XGLCD::getCursor(int16_t &x, int16_t &y)
 /******************************************************************************/
 void XGLCD::getCursorFast(int16_t &x, int16_t &y)
 {
+    _XGP_SCOPE;
 	x = _cursorX;
 	y = _cursorY;
 	if (_portrait) swapvals(x,y);
@@ -2628,12 +4611,14 @@ void XGLCD::getCursorFast(int16_t &x, int16_t &y)
 
 int16_t XGLCD::getCursorX(void)
 {
+    _XGP_SCOPE;
 	if (_portrait) return _cursorY;
 	return _cursorX;
 }
 
 int16_t XGLCD::getCursorY(void)
 {
+    _XGP_SCOPE;
 	if (_portrait) return _cursorX;
 	return _cursorY;
 }
@@ -2648,6 +4633,7 @@ int16_t XGLCD::getCursorY(void)
 /******************************************************************************/
 void XGLCD::showCursor(enum RA8875tcursor c,bool blink)
 {
+    _XGP_SCOPE;
     //uint8_t MWCR1Reg = _readRegister(RA8875_MWCR1) & 0x01;(needed?)
     uint8_t cW = 0;
     uint8_t cH = 0;
@@ -2688,6 +4674,7 @@ void XGLCD::showCursor(enum RA8875tcursor c,bool blink)
 /******************************************************************************/
 void XGLCD::setGraphicCursor(uint8_t cur)
 {
+    _XGP_SCOPE;
     if (cur > 7) cur = 7;
     uint8_t temp = _readRegister(RA8875_MWCR1);
     temp &= ~(0x70);
@@ -2698,7 +4685,7 @@ void XGLCD::setGraphicCursor(uint8_t cur)
     } else {
         temp &= ~(1 << 0);
     }
-    _writeData(temp);
+    _writeRegister(RA8875_MWCR1, temp);
 }
 
 /******************************************************************************/
@@ -2710,6 +4697,7 @@ void XGLCD::setGraphicCursor(uint8_t cur)
 /******************************************************************************/
 void XGLCD::showGraphicCursor(boolean cur)
 {
+    _XGP_SCOPE;
     uint8_t temp = _readRegister(RA8875_MWCR1);
     cur == true ? temp |= (1 << 7) : temp &= ~(1 << 7);
     if (_useMultiLayers){
@@ -2717,7 +4705,7 @@ void XGLCD::showGraphicCursor(boolean cur)
     } else {
         temp &= ~(1 << 0);
     }
-    _writeData(temp);
+    _writeRegister(RA8875_MWCR1, temp);
 }
 
 /******************************************************************************/
@@ -2729,6 +4717,7 @@ void XGLCD::showGraphicCursor(boolean cur)
 /******************************************************************************/
 void XGLCD::setCursorBlinkRate(uint8_t rate)
 {
+    _XGP_SCOPE;
 	_writeRegister(RA8875_BTCR,rate);
 }
 
@@ -2743,6 +4732,7 @@ void XGLCD::setCursorBlinkRate(uint8_t rate)
 /******************************************************************************/
 void XGLCD::cursorIncrement(bool on)
 {
+    _XGP_SCOPE;
     if (!_TXTrender){
         on == true ? _MWCR0_Reg &= ~RA8875_MWCR0_MEMWR_NO_INC : _MWCR0_Reg |= RA8875_MWCR0_MEMWR_NO_INC;
         //bitWrite(_TXTparameters,1,on);
@@ -2762,6 +4752,7 @@ void XGLCD::cursorIncrement(bool on)
 /******************************************************************************/
 void XGLCD::setTextColor(uint16_t fcolor, uint16_t bcolor)
 {
+    _XGP_SCOPE;
 	if (fcolor != _TXTForeColor) {
 		_TXTForeColor = fcolor;
 		setForegroundColor(fcolor);
@@ -2790,6 +4781,7 @@ void XGLCD::setTextColor(uint16_t fcolor, uint16_t bcolor)
 
 void XGLCD::setTextColor(uint16_t fcolor)
 {
+    _XGP_SCOPE;
 	if (fcolor != _TXTForeColor) {
 		_TXTForeColor = fcolor;
 		setForegroundColor(fcolor);
@@ -2804,6 +4796,7 @@ void XGLCD::setTextColor(uint16_t fcolor)
 
 void XGLCD::setTextGradient(uint16_t fcolor1,uint16_t fcolor2)
 {
+    _XGP_SCOPE;
 	_FNTgradient = true;
 	_FNTgradientColor1 = fcolor1;
 	_FNTgradientColor2 = fcolor2;
@@ -2818,6 +4811,7 @@ void XGLCD::setTextGradient(uint16_t fcolor1,uint16_t fcolor2)
 /******************************************************************************/
 void XGLCD::setFontScale(uint8_t scale)
 {
+    _XGP_SCOPE;
 	setFontScale(scale,scale);
 }
 
@@ -2833,6 +4827,7 @@ void XGLCD::setFontScale(uint8_t scale)
 /******************************************************************************/
 void XGLCD::setFontScale(uint8_t xscale,uint8_t yscale)
 {
+    _XGP_SCOPE;
 	_scaling = false;
 	if (!_TXTrender){
 		xscale = xscale % 4;
@@ -2857,6 +4852,7 @@ void XGLCD::setFontScale(uint8_t xscale,uint8_t yscale)
 /******************************************************************************/
 void XGLCD::setFontSpacing(uint8_t spc)
 {
+    _XGP_SCOPE;
     if (spc > RA8875_FWTSET_WIDTH_MASK) spc = RA8875_FWTSET_WIDTH_MASK;
     _FNTspacing = spc;
     if (!_TXTrender){
@@ -2878,6 +4874,7 @@ void XGLCD::setFontSpacing(uint8_t spc)
 /******************************************************************************/
 uint8_t XGLCD::getFontWidth(boolean inColums)
 {
+    _XGP_SCOPE;
 	uint8_t temp;
 
 	if (!_TXTrender){
@@ -2910,6 +4907,7 @@ uint8_t XGLCD::getFontWidth(boolean inColums)
 /******************************************************************************/
 uint8_t XGLCD::getFontHeight(boolean inRows)
 {
+    _XGP_SCOPE;
 	uint8_t temp;
 
 	if (!_TXTrender){
@@ -2938,9 +4936,22 @@ uint8_t XGLCD::getFontHeight(boolean inRows)
 
 void XGLCD::_textWrite(const char* buffer, uint16_t len)
 {
+    _XGP_SCOPE;
     uint16_t i;
 	if (len == 0) len = strlen(buffer);                                         //try get the info from the buffer
 	if (len == 0) return;                                                       //better stop here, the string is empty!
+	if (_dl) {                                                                  //record, then write without recording the rendered pixels
+		XGDisplayList *dl = _dl;
+		const int16_t p[] = {_cursorX,_cursorY,(int16_t)_TXTForeColor,(int16_t)_TXTBackColor,
+		                     (int16_t)((_absoluteCenter ? XG_DL_TEXT_ABSCENTER : 0) | (_relativeCenter ? XG_DL_TEXT_RELCENTER : 0) |
+		                               (_TXTAlignXToCenter ? XG_DL_TEXT_ALIGNX : 0) | (_TXTAlignYToCenter ? XG_DL_TEXT_ALIGNY : 0)),
+		                     (int16_t)len};
+		dl->addText(p, buffer, len);
+		_dl = NULL;
+		_textWrite(buffer, len);
+		_dl = dl;
+		return;
+	}
 	
 	uint8_t loVOffset = 0;
 	uint8_t hiVOffset = 0;
@@ -3140,7 +5151,7 @@ void XGLCD::_charWrite(const char c,uint8_t offset)
 			writeCommand(RA8875_MRWC);
         }
 		_writeData(c);
-		_waitBusy(0x80);
+		if (!_waitInt(RA8875_INTCx_FONT)) _waitBusy(0x80);
         if (!_portrait){                                                        // update cursor
 			_cursorX += _FNTwidth;
 		} else {
@@ -3210,10 +5221,9 @@ int16_t XGLCD::_STRlen_helper(const char* buffer,uint16_t len)
 /******************************************************************************/
 void XGLCD::_drawChar_unc(int16_t x,int16_t y,int charW,int index,uint16_t fcolor)
 {
-    if (x < 0) return;                                                          // X-Graph border checks
-    if ((x + charW) >= _width) return;
-    if (y < 0) return;
-    if ((y + charW) >= _height) return;
+    if (_clipTest(x, y, x + charW * _scaleX - 1, y + (_FNTheight + 1) * _scaleY - 1) == XG_CLIP_OUTSIDE) {
+        return;                                                                 // Not visible, partly visible glyphs are clipped by fillRect
+    }
     
 	const uint8_t * charGlyp = _currentFont->chars[index].image->data;          //start by getting some glyph data...
 	int			  totalBytes = _currentFont->chars[index].image->image_datalen;
@@ -3330,6 +5340,7 @@ void XGLCD::printNumF(double num, byte dec, int x, int y, char divider, int leng
 /******************************************************************************/
 void XGLCD::setColorBpp(uint8_t colors)
 {
+    _XGP_SCOPE;
 	if (colors != _color_bpp){                                                  //only if necessary
 		if (colors < 16) {
 			_color_bpp = 8;
@@ -3353,6 +5364,7 @@ void XGLCD::setColorBpp(uint8_t colors)
 /******************************************************************************/
 uint8_t XGLCD::getColorBpp(void)
 {
+    _XGP_SCOPE;
 	return _color_bpp;
 }
                              
@@ -3365,12 +5377,19 @@ uint8_t XGLCD::getColorBpp(void)
 */
 /******************************************************************************/
 void XGLCD::setForegroundColor(uint16_t color)
+{
+    _XGP_SCOPE;
+    _queueForegroundColor(color);
+    _flushRegisters();
+}
+
+void XGLCD::_queueForegroundColor(uint16_t color)
 {
 	_foreColor = color;
 
-    _writeRegister(RA8875_FGCR0,((color & 0xF800) >> _RA8875colorMask[_colorIndex]));
-    _writeRegister(RA8875_FGCR0+1,((color & 0x07E0) >> _RA8875colorMask[_colorIndex+1]));
-    _writeRegister(RA8875_FGCR0+2,((color & 0x001F) >> _RA8875colorMask[_colorIndex+2]));
+    _queueRegister(RA8875_FGCR0,((color & 0xF800) >> _RA8875colorMask[_colorIndex]));
+    _queueRegister(RA8875_FGCR0+1,((color & 0x07E0) >> _RA8875colorMask[_colorIndex+1]));
+    _queueRegister(RA8875_FGCR0+2,((color & 0x001F) >> _RA8875colorMask[_colorIndex+2]));
 }
     
 /******************************************************************************/
@@ -3384,11 +5403,13 @@ void XGLCD::setForegroundColor(uint16_t color)
 /******************************************************************************/
 void XGLCD::setForegroundColor(uint8_t R,uint8_t G,uint8_t B)
 {
+    _XGP_SCOPE;
 	_foreColor = Color565(R,G,B);
 
-    _writeRegister(RA8875_FGCR0,R);
-    _writeRegister(RA8875_FGCR0+1,G);
-    _writeRegister(RA8875_FGCR0+2,B);
+    _queueRegister(RA8875_FGCR0,R);
+    _queueRegister(RA8875_FGCR0+1,G);
+    _queueRegister(RA8875_FGCR0+2,B);
+    _flushRegisters();
 }
 /******************************************************************************/
 /*!
@@ -3401,11 +5422,13 @@ void XGLCD::setForegroundColor(uint8_t R,uint8_t G,uint8_t B)
 /******************************************************************************/
 void XGLCD::setBackgroundColor(uint16_t color)
 {
+    _XGP_SCOPE;
 	_backColor = color;
 
-    _writeRegister(RA8875_BGCR0,((color & 0xF800) >> _RA8875colorMask[_colorIndex]));//11
-    _writeRegister(RA8875_BGCR0+1,((color & 0x07E0) >> _RA8875colorMask[_colorIndex+1]));//5
-    _writeRegister(RA8875_BGCR0+2,((color & 0x001F) >> _RA8875colorMask[_colorIndex+2]));//0
+    _queueRegister(RA8875_BGCR0,((color & 0xF800) >> _RA8875colorMask[_colorIndex]));//11
+    _queueRegister(RA8875_BGCR0+1,((color & 0x07E0) >> _RA8875colorMask[_colorIndex+1]));//5
+    _queueRegister(RA8875_BGCR0+2,((color & 0x001F) >> _RA8875colorMask[_colorIndex+2]));//0
+    _flushRegisters();
 }
 /******************************************************************************/
 /*!
@@ -3419,11 +5442,13 @@ void XGLCD::setBackgroundColor(uint16_t color)
 /******************************************************************************/
 void XGLCD::setBackgroundColor(uint8_t R,uint8_t G,uint8_t B)
 {
+    _XGP_SCOPE;
 	_backColor = Color565(R,G,B);
 
-    _writeRegister(RA8875_BGCR0,R);
-    _writeRegister(RA8875_BGCR0+1,G);
-    _writeRegister(RA8875_BGCR0+2,B);
+    _queueRegister(RA8875_BGCR0,R);
+    _queueRegister(RA8875_BGCR0+1,G);
+    _queueRegister(RA8875_BGCR0+2,B);
+    _flushRegisters();
 }
 /******************************************************************************/
 /*!
@@ -3436,11 +5461,13 @@ void XGLCD::setBackgroundColor(uint8_t R,uint8_t G,uint8_t B)
 /******************************************************************************/
 void XGLCD::setTransparentColor(uint16_t color)
 {
+    _XGP_SCOPE;
 	_backColor = color;
 
-    _writeRegister(RA8875_BGTR0,((color & 0xF800) >> _RA8875colorMask[_colorIndex]));
-    _writeRegister(RA8875_BGTR0+1,((color & 0x07E0) >> _RA8875colorMask[_colorIndex+1]));
-    _writeRegister(RA8875_BGTR0+2,((color & 0x001F) >> _RA8875colorMask[_colorIndex+2]));
+    _queueRegister(RA8875_BGTR0,((color & 0xF800) >> _RA8875colorMask[_colorIndex]));
+    _queueRegister(RA8875_BGTR0+1,((color & 0x07E0) >> _RA8875colorMask[_colorIndex+1]));
+    _queueRegister(RA8875_BGTR0+2,((color & 0x001F) >> _RA8875colorMask[_colorIndex+2]));
+    _flushRegisters();
 }
 /******************************************************************************/
 /*!
@@ -3454,11 +5481,13 @@ void XGLCD::setTransparentColor(uint16_t color)
 /******************************************************************************/
 void XGLCD::setTransparentColor(uint8_t R,uint8_t G,uint8_t B)
 {
+    _XGP_SCOPE;
 	_backColor = Color565(R,G,B);//keep track
 
-    _writeRegister(RA8875_BGTR0,R);
-    _writeRegister(RA8875_BGTR0+1,G);
-    _writeRegister(RA8875_BGTR0+2,B);
+    _queueRegister(RA8875_BGTR0,R);
+    _queueRegister(RA8875_BGTR0+1,G);
+    _queueRegister(RA8875_BGTR0+2,B);
+    _flushRegisters();
 }
 
 /******************************************************************************/
@@ -3472,6 +5501,7 @@ void XGLCD::setTransparentColor(uint8_t R,uint8_t G,uint8_t B)
 /******************************************************************************/
 void XGLCD::setColor(uint16_t fcolor, uint16_t bcolor, bool bcolorTraspFlag)
 {
+    _XGP_SCOPE;
 	if (fcolor != _foreColor) setForegroundColor(fcolor);
 	if (bcolorTraspFlag){
 		setTransparentColor(bcolor);
@@ -3487,18 +5517,22 @@ void XGLCD::setColor(uint16_t fcolor, uint16_t bcolor, bool bcolorTraspFlag)
 /******************************************************************************/
 
 void XGLCD::setColor(uint16_t color) {
+    _XGP_SCOPE;
     setForegroundColor(color);
 }
                              
 void XGLCD::setColor(uint8_t r, uint8_t g, uint8_t b) {
+    _XGP_SCOPE;
     setForegroundColor(r, g, b);
 };
                              
 uint16_t XGLCD::getColor(void) {
+    _XGP_SCOPE;
     return _foreColor;
 }
 
 void XGLCD::setBackColor(uint32_t color) {
+    _XGP_SCOPE;
     setBackgroundColor((uint16_t)color);
     //if (color == VGA_TRANSPARENT) _backTransparent = true;
     //else {
@@ -3508,11 +5542,13 @@ void XGLCD::setBackColor(uint32_t color) {
 }
                              
 void XGLCD::setBackColor(uint8_t r, uint8_t g, uint8_t b) {
+    _XGP_SCOPE;
     setBackgroundColor(r, g, b);
     //_backTransparent = false;
 };
                              
 uint32_t XGLCD::getBackColor(void) {
+    _XGP_SCOPE;
     return (uint32_t)_backColor;
 }
 
@@ -3524,7 +5560,30 @@ uint32_t XGLCD::getBackColor(void) {
 
 uint8_t XGLCD::_color16To8bpp(uint16_t color)
 {
-    return (map((color & 0xF800) >> 11, 0,28, 0,7)<<5 | map((color & 0x07E0) >> 5, 0,56, 0,7)<<2 | map(color & 0x001F, 0,24, 0,3));
+    return Color565To332(color);
+}
+
+/******************************************************************************/
+/*!
+ Convert an array of RGB565 colors to RGB332 (the upper bits of each component)
+ Parameters:
+ src: RGB565 colors
+ dst: RGB332 colors, may be the same memory as src (in place conversion)
+ count: number of colors
+ */
+/******************************************************************************/
+void XGLCD::Color565To332(const uint16_t *src, uint8_t *dst, uint32_t count)
+{
+    while (count >= 4) {
+        dst[0] = Color565To332(src[0]);
+        dst[1] = Color565To332(src[1]);
+        dst[2] = Color565To332(src[2]);
+        dst[3] = Color565To332(src[3]);
+        src += 4;
+        dst += 4;
+        count -= 4;
+    }
+    while (count--) *dst++ = Color565To332(*src++);
 }
 
 /******************************************************************************/
@@ -3535,6 +5594,7 @@ uint8_t XGLCD::_color16To8bpp(uint16_t color)
 /******************************************************************************/
 uint16_t XGLCD::gradient(uint8_t val)
 {
+    _XGP_SCOPE;
     uint8_t r = 0;
     uint8_t g = 0;
     uint8_t b = 0;
@@ -3569,6 +5629,7 @@ uint16_t XGLCD::gradient(uint8_t val)
 /******************************************************************************/
 uint16_t XGLCD::colorInterpolation(uint16_t color1,uint16_t color2,uint16_t pos,uint16_t div)
 {
+    _XGP_SCOPE;
     if (pos == 0) return color1;
     if (pos >= div) return color2;
     uint8_t r1,g1,b1;
@@ -3595,6 +5656,7 @@ uint16_t XGLCD::colorInterpolation(uint16_t color1,uint16_t color2,uint16_t pos,
 /******************************************************************************/
 uint16_t XGLCD::colorInterpolation(uint8_t r1,uint8_t g1,uint8_t b1,uint8_t r2,uint8_t g2,uint8_t b2,uint16_t pos,uint16_t div)
 {
+    _XGP_SCOPE;
     if (pos == 0) return Color565(r1,g1,b1);
     if (pos >= div) return Color565(r2,g2,b2);
     float pos2 = (float)pos/div;
@@ -3620,6 +5682,7 @@ uint16_t XGLCD::colorInterpolation(uint8_t r1,uint8_t g1,uint8_t b1,uint8_t r2,u
 /*****************************************************************************/
 void XGLCD::setScrollMode(enum RA8875scrollMode mode)
 {
+    _XGP_SCOPE;
     uint8_t temp = _readRegister(RA8875_LTPR0);
     temp &= 0x3F;
     switch(mode){
@@ -3641,7 +5704,7 @@ void XGLCD::setScrollMode(enum RA8875scrollMode mode)
     //TODO: Should this be conditional on multi layer?
     //if (_useMultiLayers) _writeRegister(RA8875_LTPR0,temp);
     //_writeRegister(RA8875_LTPR0,temp);
-	_writeData(temp);
+	_writeRegister(RA8875_LTPR0, temp);
 }
 
 /******************************************************************************/
@@ -3657,6 +5720,7 @@ void XGLCD::setScrollMode(enum RA8875scrollMode mode)
 /******************************************************************************/
 void XGLCD::setScrollWindow(int16_t XL,int16_t XR ,int16_t YT ,int16_t YB)
 {
+    _XGP_SCOPE;
 	if (_portrait){
 		swapvals(XL,YT);
 		swapvals(XR,YB);
@@ -3666,17 +5730,18 @@ void XGLCD::setScrollWindow(int16_t XL,int16_t XR ,int16_t YT ,int16_t YB)
 	_checkLimits_helper(XR,YB);
 	
 	_scrollXL = XL; _scrollXR = XR; _scrollYT = YT; _scrollYB = YB;
-    _writeRegister(RA8875_HSSW0,(_scrollXL & 0xFF));
-    _writeRegister(RA8875_HSSW0+1,(_scrollXL >> 8));
+    _queueRegister(RA8875_HSSW0,(_scrollXL & 0xFF));
+    _queueRegister(RA8875_HSSW0+1,(_scrollXL >> 8));
   
-    _writeRegister(RA8875_HESW0,(_scrollXR & 0xFF));
-    _writeRegister(RA8875_HESW0+1,(_scrollXR >> 8));   
+    _queueRegister(RA8875_HESW0,(_scrollXR & 0xFF));
+    _queueRegister(RA8875_HESW0+1,(_scrollXR >> 8));   
     
-    _writeRegister(RA8875_VSSW0,(_scrollYT & 0xFF));
-    _writeRegister(RA8875_VSSW0+1,(_scrollYT >> 8));   
+    _queueRegister(RA8875_VSSW0,(_scrollYT & 0xFF));
+    _queueRegister(RA8875_VSSW0+1,(_scrollYT >> 8));   
  
-    _writeRegister(RA8875_VESW0,(_scrollYB & 0xFF));
-    _writeRegister(RA8875_VESW0+1,(_scrollYB >> 8));
+    _queueRegister(RA8875_VESW0,(_scrollYB & 0xFF));
+    _queueRegister(RA8875_VESW0+1,(_scrollYB >> 8));
+	_flushRegisters();
 	delay(1);
 }
 
@@ -3688,6 +5753,7 @@ void XGLCD::setScrollWindow(int16_t XL,int16_t XR ,int16_t YT ,int16_t YB)
 /******************************************************************************/
 void XGLCD::scroll(int16_t x,int16_t y)
 { 
+    _XGP_SCOPE;
 	if (_portrait) swapvals(x,y);
 	//if (y > _scrollYB) y = _scrollYB;//??? mmmm... not sure
 	if (_scrollXL == 0 && _scrollXR == 0 && _scrollYT == 0 && _scrollYB == 0){  //do nothing, scroll window inactive
@@ -3732,6 +5798,7 @@ void XGLCD::scroll(int16_t x,int16_t y)
 
 void  XGLCD::BTE_move(int16_t SourceX, int16_t SourceY, int16_t Width, int16_t Height, int16_t DestX, int16_t DestY, uint8_t SourceLayer, uint8_t DestLayer,bool Transparent, uint8_t ROP, bool Monochrome, bool ReverseDir)
 {
+    _XGP_SCOPE;
 	
 	if (SourceLayer == 0) SourceLayer = _currentLayer;
 	if (DestLayer == 0) DestLayer = _currentLayer;
@@ -3756,14 +5823,14 @@ void  XGLCD::BTE_move(int16_t SourceX, int16_t SourceY, int16_t Width, int16_t H
 		}
 	}
 
-	_waitBusy(0x40);                                                            //Check that another BTE operation is not still in progress // X-Graph ??? Based on which register ???
+	if (!_useInt) _waitBusy(0x40);                                              //Check that another BTE operation is not still in progress (with interrupts every BTE is waited for below)
 	if (_textMode) _setTextMode(false);                                         //we are in text mode?
 	BTE_moveFrom(SourceX,SourceY);
 	BTE_size(Width,Height);
 	BTE_moveTo(DestX,DestY);
 	BTE_ropcode(ROP);
 	if (Monochrome) _writeRegister(RA8875_BECR0, 0xC0); else _writeRegister(RA8875_BECR0, 0x80); //Execute BTE! (This selects linear addressing mode for the monochrome source data)
-	_waitBusy(0x40);
+	_waitEngine(RA8875_BECR0, 0x40);
 	//we are supposed to wait for the thing to become unbusy
 	//caller can call _waitBusy(0x40) to check the BTE busy status (except it's private)
 }
@@ -3775,11 +5842,13 @@ void  XGLCD::BTE_move(int16_t SourceX, int16_t SourceY, int16_t Width, int16_t H
 /******************************************************************************/
 void XGLCD::BTE_size(int16_t w, int16_t h)
 {
+    _XGP_SCOPE;
 	if (_portrait) swapvals(w,h);
-    _writeRegister(RA8875_BEWR0,w & 0xFF);
-    _writeRegister(RA8875_BEWR0+1,w >> 8);
-    _writeRegister(RA8875_BEHR0,h & 0xFF);
-    _writeRegister(RA8875_BEHR0+1,h >> 8);
+    _queueRegister(RA8875_BEWR0,w & 0xFF);
+    _queueRegister(RA8875_BEWR0+1,w >> 8);
+    _queueRegister(RA8875_BEHR0,h & 0xFF);
+    _queueRegister(RA8875_BEHR0+1,h >> 8);
+    _flushRegisters();
 }	
 
 /******************************************************************************/
@@ -3790,11 +5859,13 @@ void XGLCD::BTE_size(int16_t w, int16_t h)
 
 void XGLCD::BTE_moveFrom(int16_t SX,int16_t SY)
 {
+    _XGP_SCOPE;
 	if (_portrait) swapvals(SX,SY);
-	_writeRegister(RA8875_HSBE0,SX & 0xFF);
-	_writeRegister(RA8875_HSBE0+1,SX >> 8);
-	_writeRegister(RA8875_VSBE0,SY & 0xFF);
-	_writeRegister(RA8875_VSBE0+1,SY >> 8);
+	_queueRegister(RA8875_HSBE0,SX & 0xFF);
+	_queueRegister(RA8875_HSBE0+1,SX >> 8);
+	_queueRegister(RA8875_VSBE0,SY & 0xFF);
+	_queueRegister(RA8875_VSBE0+1,SY >> 8);
+    _flushRegisters();
 }	
 
 /******************************************************************************/
@@ -3805,11 +5876,13 @@ void XGLCD::BTE_moveFrom(int16_t SX,int16_t SY)
 
 void XGLCD::BTE_moveTo(int16_t DX,int16_t DY)
 {
+    _XGP_SCOPE;
 	if (_portrait) swapvals(DX,DY);
-	_writeRegister(RA8875_HDBE0,DX & 0xFF);
-	_writeRegister(RA8875_HDBE0+1,DX >> 8);
-	_writeRegister(RA8875_VDBE0,DY & 0xFF);
-	_writeRegister(RA8875_VDBE0+1,DY >> 8);
+	_queueRegister(RA8875_HDBE0,DX & 0xFF);
+	_queueRegister(RA8875_HDBE0+1,DX >> 8);
+	_queueRegister(RA8875_VDBE0,DY & 0xFF);
+	_queueRegister(RA8875_VDBE0+1,DY >> 8);
+    _flushRegisters();
 }	
 
 /******************************************************************************/
@@ -3819,6 +5892,7 @@ void XGLCD::BTE_moveTo(int16_t DX,int16_t DY)
 /******************************************************************************/
 void XGLCD::BTE_ropcode(unsigned char setx)
 {
+    _XGP_SCOPE;
     _writeRegister(RA8875_BECR1,setx);
 }
 
@@ -3829,10 +5903,10 @@ void XGLCD::BTE_ropcode(unsigned char setx)
 /******************************************************************************/
 void XGLCD::BTE_enable(bool on)
 {	
+    _XGP_SCOPE;
 	uint8_t temp = _readRegister(RA8875_BECR0);
 	on == true ? temp &= ~(1 << 7) : temp |= (1 << 7);
-	_writeData(temp);
-	//_writeRegister(RA8875_BECR0,temp);  
+	_writeRegister(RA8875_BECR0, temp);
 	_waitBusy(0x40);
 }
 
@@ -3844,10 +5918,10 @@ void XGLCD::BTE_enable(bool on)
 /******************************************************************************/
 void XGLCD::BTE_dataMode(enum RA8875btedatam m)
 {	
+    _XGP_SCOPE;
 	uint8_t temp = _readRegister(RA8875_BECR0);
 	m == CONT ? temp &= ~(1 << 6) : temp |= (1 << 6);
-	_writeData(temp);
-	//_writeRegister(RA8875_BECR0,temp);  
+	_writeRegister(RA8875_BECR0, temp);
 }
 
 /******************************************************************************/
@@ -3858,11 +5932,12 @@ void XGLCD::BTE_dataMode(enum RA8875btedatam m)
 
 void XGLCD::BTE_layer(enum RA8875btelayer sd,uint8_t l)
 {
+    _XGP_SCOPE;
 	uint8_t temp;
-	sd == SOURCE ? temp = _readRegister(RA8875_VSBE0+1) : temp = _readRegister(RA8875_VDBE0+1);
+	uint8_t reg = (sd == SOURCE) ? RA8875_VSBE0+1 : RA8875_VDBE0+1;
+	temp = _readRegister(reg);
 	l == 1 ? temp &= ~(1 << 7) : temp |= (1 << 7);
-	_writeData(temp);
-	//_writeRegister(RA8875_VSBE1,temp);  
+	_writeRegister(reg, temp);
 }
 
 /*
@@ -3883,6 +5958,7 @@ void XGLCD::BTE_layer(enum RA8875btelayer sd,uint8_t l)
 /******************************************************************************/
 void XGLCD::useLayers(boolean on)
 {
+    _XGP_SCOPE;
 	if (_useMultiLayers == on) return;                                          //no reason to do change that it's already as desidered.
 	if (_color_bpp > 8) {                                                       //try to set up 8bit color space
 		setColorBpp(8);
@@ -3911,6 +5987,7 @@ void XGLCD::useLayers(boolean on)
 /******************************************************************************/
 void XGLCD::layerEffect(enum RA8875boolean efx)
 {
+    _XGP_SCOPE;
 	uint8_t	reg = 0b00000000;
 	if (!_useMultiLayers) useLayers(true);                                      // turn on multiple layers if it's off
 	switch(efx){                                                                // bit 2,1,0 of LTPR0
@@ -3948,6 +6025,7 @@ void XGLCD::layerEffect(enum RA8875boolean efx)
 /******************************************************************************/
 void XGLCD::layerTransparency(uint8_t layer1,uint8_t layer2)
 {
+    _XGP_SCOPE;
 	if (layer1 > 8) layer1 = 8;
 	if (layer2 > 8) layer2 = 8;
 	if (!_useMultiLayers) useLayers(true);                                      //turn on multiple layers if it's off
@@ -3964,6 +6042,7 @@ void XGLCD::layerTransparency(uint8_t layer1,uint8_t layer2)
 /******************************************************************************/
 uint8_t XGLCD::getCurrentLayer(void)
 {
+    _XGP_SCOPE;
 	if (!_useMultiLayers) return 255;
 	return _currentLayer;
 }
@@ -3975,6 +6054,7 @@ uint8_t XGLCD::getCurrentLayer(void)
 /******************************************************************************/
 void XGLCD::setPattern(uint8_t num, enum RA8875pattern p)
 {
+    _XGP_SCOPE;
 	uint8_t maxLoc;
 	uint8_t temp = 0b00000000;
 	if (p != P16X16) {
@@ -3996,6 +6076,7 @@ void XGLCD::setPattern(uint8_t num, enum RA8875pattern p)
 /******************************************************************************/
 void XGLCD::writePattern(int16_t x,int16_t y,const uint8_t *data,uint8_t size,bool setAW)
 {
+    _XGP_SCOPE;
 	int16_t i;
 	int16_t a,b,c,d;
 	if (size < 8 || size > 16) return;
@@ -4029,6 +6110,7 @@ void XGLCD::writePattern(int16_t x,int16_t y,const uint8_t *data,uint8_t size,bo
 /******************************************************************************/
 void XGLCD::writeTo(enum RA8875writes d)
 {
+    _XGP_SCOPE;
 	uint8_t temp = _readRegister(RA8875_MWCR1);
 	//bool trigMultilayer = false;
 	switch(d){
@@ -4037,16 +6119,15 @@ void XGLCD::writeTo(enum RA8875writes d)
 			temp &= ~(1 << 0);
 			_currentLayer = 0;
 			//trigMultilayer = true;
-            _writeData(temp);
+            _writeRegister(RA8875_MWCR1,temp);
 			if (!_useMultiLayers) useLayers(true);
-            _writeData(temp);
 		break;
         case L2:
 			temp &= ~((1<<3) | (1<<2));
 			temp |= (1 << 0);
 			_currentLayer = 1;
 			//trigMultilayer = true;
-			_writeData(temp);  
+			_writeRegister(RA8875_MWCR1,temp);  
 			if (!_useMultiLayers) useLayers(true);
 		break;
 		case CGRAM:
@@ -4057,18 +6138,18 @@ void XGLCD::writeTo(enum RA8875writes d)
 				_writeRegister(RA8875_FNCR0,_FNCR0_Reg);  
 				_writeRegister(RA8875_MWCR1,temp);
 			} else {
-				_writeData(temp);  
+				_writeRegister(RA8875_MWCR1,temp);  
 			}
 		break;
         case PATTERN:
 			temp |= (1 << 3);
 			temp |= (1 << 2);
-			_writeData(temp);  
+			_writeRegister(RA8875_MWCR1,temp);  
 		break;
 		case CURSOR:
 			temp |= (1 << 3);
 			temp &= ~(1 << 2);
-			_writeData(temp);  
+			_writeRegister(RA8875_MWCR1,temp);  
 		break;
 		default:
 		//break;
@@ -4096,6 +6177,7 @@ void XGLCD::writeTo(enum RA8875writes d)
 /******************************************************************************/
 void XGLCD::PWMout(uint8_t pw,uint8_t p)
 {
+    _XGP_SCOPE;
 	uint8_t reg;
 	pw > 1 ? reg = RA8875_P2DCR : reg = RA8875_P1DCR;
 	_writeRegister(reg, p);
@@ -4111,6 +6193,7 @@ void XGLCD::PWMout(uint8_t pw,uint8_t p)
 /******************************************************************************/
 void XGLCD::brightness(uint8_t val)
 {
+    _XGP_SCOPE;
 	_brightness = val;
 	PWMout(1,_brightness);
 }
@@ -4124,6 +6207,7 @@ void XGLCD::brightness(uint8_t val)
 /******************************************************************************/
 void XGLCD::backlight(boolean on)
 {
+    _XGP_SCOPE;
 	if (on == true){
         PWMsetup(1,true, RA8875_PWM_CLK_DIV1024);                               //setup PWM ch 1 for backlight
         PWMout(1,_brightness);                                                  //turn on PWM1
@@ -4144,6 +6228,7 @@ void XGLCD::backlight(boolean on)
 /******************************************************************************/
 void XGLCD::PWMsetup(uint8_t pw,boolean on, uint8_t clock)
 {
+    _XGP_SCOPE;
 	uint8_t reg;
 	uint8_t set;
 	if (pw > 1){
@@ -4183,6 +6268,7 @@ void XGLCD::PWMsetup(uint8_t pw,boolean on, uint8_t clock)
 
 void XGLCD::touchBegin(void)
 {
+    _XGP_SCOPE;
     _writeRegister(RA8875_TPCR0, RA8875_TPCR0_TOUCH);
     _writeRegister(RA8875_TPCR1, RA8875_TPCR1_WAIT);
 }
@@ -4270,6 +6356,7 @@ bool XGLCD::readTouchADC(uint32_t *x, uint32_t *y)
 /******************************************************************************/
 bool XGLCD::touchReadAdc(uint32_t *x, uint32_t *y)
 {
+    _XGP_SCOPE;
     uint32_t tx,ty;
     bool touched;
     
@@ -4294,6 +6381,7 @@ bool XGLCD::touchReadAdc(uint32_t *x, uint32_t *y)
 /******************************************************************************/
 bool XGLCD::touchReadPixel(uint32_t *x, uint32_t *y)
 {
+    _XGP_SCOPE;
 	uint32_t tx,ty;
     bool touched;
     
@@ -4311,7 +6399,7 @@ bool XGLCD::touchReadPixel(uint32_t *x, uint32_t *y)
 
 /******************************************************************************/
 /*! PRIVATE
-		Write in a register
+		Write in a register, pending _queueRegister() writes go first
 		Parameters:
 		reg: the register
 		val: the data
@@ -4319,6 +6407,11 @@ bool XGLCD::touchReadPixel(uint32_t *x, uint32_t *y)
 /******************************************************************************/
 void XGLCD::_writeRegister(const uint8_t reg, uint8_t val)
 {
+    if (_dmaBusy) waitIdle();
+    _flushRegisters();                                                          // Keep the register write order
+    if (!_shadowUpdate(reg, val)) return;                                       // No-op write
+    if (_pendReg && _regConflicts(reg)) _syncEngine();
+    _XGP_REG;
     _spiCSLow;                                                                  //writeCommand(reg);
     _spiwrite16(RA8875_CMDWRITE+reg);
     _spiCSHigh;
@@ -4328,6 +6421,59 @@ void XGLCD::_writeRegister(const uint8_t reg, uint8_t val)
     _spiCSHigh;
 }
 
+/******************************************************************************/
+/*! PRIVATE
+		Queue a register write, the queue is sent by _flushRegisters()
+		Use this for groups of registers (coordinates, windows, colors)
+		Parameters:
+		reg: the register
+		val: the data
+*/
+/******************************************************************************/
+void XGLCD::_queueRegister(const uint8_t reg, uint8_t val)
+{
+    if (!_shadowUpdate(reg, val)) return;                                       // No-op write
+    if (_pendReg && _regConflicts(reg)) _syncEngine();
+    if (_regBurstLen > (sizeof(_regBurst)/sizeof(_regBurst[0])) - 2) _flushRegisters();
+    _XGP_REG;
+    _regBurst[_regBurstLen++] = RA8875_CMDWRITE + reg;
+    _regBurst[_regBurstLen++] = val;                                            // RA8875_DATAWRITE = 0x00
+}
+
+/******************************************************************************/
+/*! PRIVATE
+		Queue an extra data write (second byte of a 16 bit pixel after
+		_queueRegister(RA8875_MRWC, ...))
+*/
+/******************************************************************************/
+void XGLCD::_queueData(uint8_t val)
+{
+    if (_regBurstLen >= (sizeof(_regBurst)/sizeof(_regBurst[0]))) _flushRegisters();
+    _regBurst[_regBurstLen++] = val;                                            // RA8875_DATAWRITE = 0x00
+}
+
+/******************************************************************************/
+/*! PRIVATE
+		Send all queued register writes in one burst
+*/
+/******************************************************************************/
+void XGLCD::_flushRegisters(void)
+{
+    if (_regBurstLen == 0) return;
+    if (_dmaBusy) waitIdle();
+#ifdef _spiburst16
+    _spiburst16(_regBurst, _regBurstLen);
+#else
+    for (uint8_t i = 0; i < _regBurstLen; i++) {
+        _spiCSLow;
+        _spiwrite16(_regBurst[i]);
+        _spiCSHigh;
+        _spiCSHigh;
+    }
+#endif
+    _regBurstLen = 0;
+}
+
 /******************************************************************************/
 /*! PRIVATE
 		Returns the value inside register
@@ -4337,8 +6483,115 @@ void XGLCD::_writeRegister(const uint8_t reg, uint8_t val)
 /******************************************************************************/
 uint8_t XGLCD::_readRegister(const uint8_t reg)
 {
+    uint8_t val;
+    
+    if (_regIsVolatile(reg)) {
+        writeCommand(reg);
+        return _readData(false);
+    }
+    if (_regShadowValid[reg >> 5] & (1UL << (reg & 0x1F))) return _regShadow[reg];
 	writeCommand(reg);
-	return _readData(false);
+	val = _readData(false) & ~_regBusyBits(reg);
+    _regShadow[reg] = val;
+    _regShadowValid[reg >> 5] |= (1UL << (reg & 0x1F));
+    return val;
+}
+
+/******************************************************************************/
+/*! PRIVATE
+		Returns true when the register can change without a host write
+		(status/trigger bits, touch and key data, memory port), these are
+		never served from or compared against the shadow table
+		Parameters:
+		reg: the register
+*/
+/******************************************************************************/
+bool XGLCD::_regIsVolatile(const uint8_t reg)
+{
+    switch (reg) {
+        case RA8875_PWRR:                                                       // Soft reset / sleep sequence
+        case RA8875_MRWC:                                                       // Memory data port
+        case RA8875_GPI:
+        case RA8875_DCR:                                                        // Draw start/busy
+        case RA8875_ELLIPSE:                                                    // Draw start/busy
+        case RA8875_DMACR:                                                      // DMA start/busy
+        case RA8875_TPCR1:
+        case RA8875_TPXH:
+        case RA8875_TPYH:
+        case RA8875_TPXYL:
+        case RA8875_KSCR2:
+        case RA8875_KSDR0:
+        case RA8875_KSDR1:
+        case RA8875_KSDR2:
+        case RA8875_GPIOX:
+        case RA8875_INTC2:                                                      // Write 1 to clear
+            return true;
+        default:
+            return false;
+    }
+}
+
+/******************************************************************************/
+/*! PRIVATE
+		Returns the start/busy bits of a register that also holds control
+		bits. Only the control bits are shadowed (the busy bits read as 0,
+		poll them with _waitBusy) and writes to it are never skipped, they
+		start or stop the operation
+		Parameters:
+		reg: the register
+*/
+/******************************************************************************/
+uint8_t XGLCD::_regBusyBits(const uint8_t reg)
+{
+    switch (reg) {
+        case RA8875_BECR0:                                                      // BTE start/busy, bit 6 = data mode
+        case RA8875_MCLR:                                                       // Clear start/busy, bit 6 = active window only
+            return 0x80;
+        default:
+            return 0;
+    }
+}
+
+/******************************************************************************/
+/*! PRIVATE
+		Update the shadow table for a register write
+		Returns false when the register already holds val (write can be skipped)
+		Parameters:
+		reg: the register
+		val: the data
+*/
+/******************************************************************************/
+bool XGLCD::_shadowUpdate(const uint8_t reg, uint8_t val)
+{
+    uint8_t busy = _regBusyBits(reg);
+    
+    if (_regIsVolatile(reg)) return true;
+    if (!busy && (_regShadowValid[reg >> 5] & (1UL << (reg & 0x1F))) && _regShadow[reg] == val) return false;
+    _regShadow[reg] = val & ~busy;
+    _regShadowValid[reg >> 5] |= (1UL << (reg & 0x1F));
+    return true;
+}
+
+/******************************************************************************/
+/*! PRIVATE
+		Forget all shadowed register values (after reset)
+*/
+/******************************************************************************/
+void XGLCD::_invalidateShadow(void)
+{
+    for (uint8_t i = 0; i < 8; i++) _regShadowValid[i] = 0;
+}
+
+/******************************************************************************/
+/*! PRIVATE
+		Forget the shadowed cursor registers. The RA8875 moves the text and
+		memory read/write cursors by itself on every access to MRWC
+*/
+/******************************************************************************/
+void XGLCD::_invalidateCursorShadow(void)
+{
+    _regShadowValid[RA8875_F_CURXL >> 5] &= ~(0x0FUL << (RA8875_F_CURXL & 0x1F));  // F_CURXL..F_CURYH [0x2A..0x2D]
+    _regShadowValid[RA8875_CURH0 >> 5] &= ~(0xFFUL << (RA8875_CURH0 & 0x1F));      // CURH0..RCURV1 [0x46..0x4D]
 }
 
 /******************************************************************************/
@@ -4350,6 +6603,7 @@ uint8_t XGLCD::_readRegister(const uint8_t reg)
 /******************************************************************************/
 void XGLCD::_writeData(uint8_t data)
 {
+    if (_dmaBusy) waitIdle();
     _spiCSLow;
     //_spiwrite(RA8875_DATAWRITE);_spiwrite(data);
     _spiwrite16(data);                                                          // RA8875_DATAWRITE = 0x00 (so skip the addition to speed up things)
@@ -4365,6 +6619,7 @@ void XGLCD::_writeData(uint8_t data)
 /******************************************************************************/
 void  XGLCD::_writeData16(uint16_t data)
 {
+    if (_dmaBusy) waitIdle();
     _spiCSLow;
 #ifdef _spiwrite24
     _spiwrite24(RA8875_DATAWRITE, data);
@@ -4375,6 +6630,174 @@ void  XGLCD::_writeData16(uint16_t data)
     _spiCSHigh;
 }
 
+#ifdef _spiwritebuf
+/******************************************************************************/
+/*!
+		Write a block of pixels in the current data write (CS low, DATAWRITE
+		send): the pixels are converted into the staging buffer and send with
+		one bulk transfer per XG_SPI_STAGE bytes
+		Parameters:
+		p: RGB565 pixels, NULL = count times color
+		color: RGB565 color used when p is NULL
+		count: number of pixels
+*/
+/******************************************************************************/
+void XGLCD::_writeStaged(const uint16_t *p, uint16_t color, uint32_t count)
+{
+    uint8_t *b;
+    uint16_t i, n;
+    uint8_t hi = color >> 8, lo = color & 0xFF, c8 = _color16To8bpp(color);
+
+    if (_color_bpp > 8) {                                                       // 2 bytes per pixel, high byte first
+        while (count) {
+            n = (count > (XG_SPI_STAGE / 2)) ? (XG_SPI_STAGE / 2) : count;
+            b = _spiStage;
+            if (p) {
+                for (i = 0; i < n; i++) {*b++ = p[i] >> 8; *b++ = p[i] & 0xFF;}
+                p += n;
+            } else {
+                for (i = 0; i < n; i++) {*b++ = hi; *b++ = lo;}                 // Refilled every chunk, SPI.transfer can overwrite the buffer
+            }
+            _spiwritebuf(_spiStage, n * 2);
+            count -= n;
+        }
+    } else {                                                                    // 1 byte per pixel (RGB332)
+        while (count) {
+            n = (count > XG_SPI_STAGE) ? XG_SPI_STAGE : count;
+            b = _spiStage;
+            if (p) {
+                Color565To332(p, _spiStage, n);
+                p += n;
+            } else {
+                memset(_spiStage, c8, n);
+            }
+            _spiwritebuf(_spiStage, n);
+            count -= n;
+        }
+    }
+}
+#endif
+
+/******************************************************************************/
+/*!
+		Write RGB332 pixels after MRWC, the byte array is send as is (see
+		_writeBytes). With 16 bit colors the pixels are expanded one by one.
+		Parameters:
+		p: RGB332 pixels
+		count: number of pixels
+*/
+/******************************************************************************/
+void XGLCD::_writePixels8(const uint8_t *p, uint32_t count)
+{
+    if (_color_bpp > 8) {
+        while (count--) _writeData16(Color332To565(*p++));
+        return;
+    }
+    _writeBytes(p, count);
+}
+
+/******************************************************************************/
+/*!
+		Write bytes after MRWC as they are (8 bit pixels, color expansion
+		data), 2 bytes per 16 bit frame, an odd last byte on its own.
+		ESP32: the DMA reads 32 bit words, an unaligned p (a blit offset) is
+		copied through the staging buffer first.
+		Parameters:
+		p: data
+		count: number of bytes
+*/
+/******************************************************************************/
+void XGLCD::_writeBytes(const uint8_t *p, uint32_t count)
+{
+    uint32_t words = count / 2;
+    uint16_t *w = (uint16_t *)p;
+
+#ifdef _spixwritedma
+    if ((uintptr_t)p & 3) {                                                     // Not 4 byte aligned: send aligned copies
+        uint32_t n;
+        
+        while (count > 1) {
+            n = (count > XG_SPI_STAGE) ? XG_SPI_STAGE : (count & ~1UL);
+            memcpy(_spiStage, p, n);
+            _writeBytes(_spiStage, n);
+            p += n;
+            count -= n;
+        }
+        if (count) _writeData(*p);
+        return;
+    }
+#endif
+    if (words) {
+        if (_dmaBusy) waitIdle();
+        _spiCSLow;
+#ifdef _spixwritedma
+        _spixwritedma(RA8875_DATAWRITE, w, words);
+#else
+        _spiwrite(RA8875_DATAWRITE);
+        _spiwritedma(w, words);
+#endif
+        _spiCSHigh;
+    }
+    if (count & 1) _writeData(p[count - 1]);
+}
+
+/******************************************************************************/
+/*!
+		Write RGB565 pixels after MRWC, high byte first (8 bit colors: converted
+		to RGB332) using the fastest bulk write of the CPU
+		Parameters:
+		p: RGB565 pixels
+		count: number of pixels
+*/
+/******************************************************************************/
+void XGLCD::_writePixels16(const uint16_t *p, uint32_t count)
+{
+#ifdef _spiwrite24                                                              // ESP32: hardware CS, every staged chunk is one DMA transaction with its own DATAWRITE
+    uint32_t i, n, len;
+    uint16_t *w;
+
+    while (count) {
+        if (_color_bpp > 8) {
+            n = (count > (XG_SPI_STAGE / 2)) ? (XG_SPI_STAGE / 2) : count;
+            w = (uint16_t *)_spiStage;
+            for (i = 0; i < n; i++) w[i] = (p[i] >> 8) | (p[i] << 8);           // DMA sends memory order
+            len = n;                                                            // _spixwritedma changes len and w
+            if (_dmaBusy) waitIdle();
+            _spixwritedma(RA8875_DATAWRITE, w, len);
+        } else {
+            n = (count > XG_SPI_STAGE) ? XG_SPI_STAGE : count;
+            Color565To332(p, _spiStage, n);
+            _writePixels8(_spiStage, n);
+        }
+        p += n;
+        count -= n;
+    }
+#else
+    if (_dmaBusy) waitIdle();
+    _spiCSLow;
+    _spiwrite(RA8875_DATAWRITE);
+#ifdef _spiwritedmaswap
+    if (_color_bpp > 8) {                                                       // Pixels are send high byte first by the DMA controller
+        _spiwritedmaswap(p, count);
+        _spiCSHigh;
+        return;
+    }
+#endif
+#ifdef _spiwritebuf
+    _writeStaged(p, 0, count);
+#else
+    uint32_t i;
+    
+    if (_color_bpp > 8) {
+        for (i=0;i<count;i++) _spiwrite16(p[i]);
+    } else {                                                                    //TOTEST:layer bug workaround for 8bit color!
+        for (i=0;i<count;i++) _spiwrite(_color16To8bpp(p[i]));
+    }
+#endif
+    _spiCSHigh;
+#endif
+}
+
 /******************************************************************************/
 /*!	PRIVATE
 
@@ -4384,7 +6807,23 @@ uint8_t XGLCD::_readData(bool stat)
 {
     uint8_t x;
     
+    if (_dmaBusy) waitIdle();
     _spisetSpeed(SPI_SPEED_READ);
+    x = _readDataFast(stat);
+    _spisetSpeed(SPI_SPEED_WRITE);
+    return x;
+
+}
+
+/******************************************************************************/
+/*!	PRIVATE
+	Read cycle only, the bus must be at SPI_SPEED_READ already
+*/
+/******************************************************************************/
+uint8_t XGLCD::_readDataFast(bool stat)
+{
+    uint8_t x;
+    
     _spiCSLow;
 #ifdef _spixread
     if (stat == true) {_spixread(RA8875_CMDREAD, x);} else {_spixread(RA8875_DATAREAD, x);}
@@ -4394,9 +6833,7 @@ uint8_t XGLCD::_readData(bool stat)
     _spiread(x);
 #endif
     _spiCSHigh;
-    _spisetSpeed(SPI_SPEED_WRITE);
     return x;
-
 }
 
 /******************************************************************************/
@@ -4406,21 +6843,218 @@ uint8_t XGLCD::_readData(bool stat)
 /******************************************************************************/
 uint8_t	XGLCD::readStatus(void)
 {
+    _XGP_SCOPE;
 	return _readData(true);
 }
 
 /******************************************************************************/
 /*! PRIVATE
-		Write a command
+		Write a command, pending _queueRegister() writes go first
 		Parameters:
 		d: the command
 */
 /******************************************************************************/
 void XGLCD::writeCommand(const uint8_t d)
 {
+    _XGP_SCOPE;
+    if (_dmaBusy) waitIdle();
+    _flushRegisters();                                                          // Keep the register write order
+    if (_pendReg && _regConflicts(d)) _syncEngine();
+    if (d == RA8875_MRWC) _invalidateCursorShadow();
+    _XGP_CMD;
     _spiCSLow;
 	//_spiwrite(RA8875_CMDWRITE);_spiwrite(d);
     _spiwrite16(RA8875_CMDWRITE+d);
     _spiCSHigh;
 }
 
+#if defined(XG_CPU_MKR) && !defined(XG_MKR_NO_DMA)
+/*
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
++							SAMD21 DMAC (ARDUINO MKR)					       +
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+Bulk pixel data is moved from RAM to SERCOM1 (SPI) by the DMA controller.
+Transfers longer then 64kB are split in chained descriptors, the CPU only
+waits (blocking) or is free until XG_DMAC_Handler() (drawBitmapAsync).
+The DMAC_Handler() interrupt routine is defined here unless XG_DMAC_SHARED
+is set, then the DMAC_Handler() of the other library must call
+XG_DMAC_Handler().
+*/
+
+static DmacDescriptor _xgDmacBase[XG_DMAC_CHANNEL+1] __attribute__((aligned(16)));   // Descriptor table (if we own the DMAC)
+static DmacDescriptor _xgDmacWB[XG_DMAC_CHANNEL+1] __attribute__((aligned(16)));     // Write-back table (if we own the DMAC)
+static DmacDescriptor _xgDmacChain[XG_DMAC_CHAIN-1] __attribute__((aligned(16)));    // Linked descriptors
+static DmacDescriptor *_xgDmacDesc = NULL;                                      // First descriptor of our channel
+static XGLCD *_xgDmacOwner = NULL;                                              // Instance used by XG_DMAC_Handler()
+
+/******************************************************************************/
+/*! PRIVATE
+		Setup the DMAC channel for SERCOM1 TX
+		XG_DMAC_SHARED: when the other library already enabled the DMAC, its
+		descriptor table is shared (only our channel entry is used)
+*/
+/******************************************************************************/
+void XGLCD::_dmacInit(void)
+{
+    PM->AHBMASK.reg |= PM_AHBMASK_DMAC;
+    PM->APBBMASK.reg |= PM_APBBMASK_DMAC;
+#if defined(XG_DMAC_SHARED)
+    if (DMAC->CTRL.reg & DMAC_CTRL_DMAENABLE) {
+        _xgDmacDesc = &((DmacDescriptor *)DMAC->BASEADDR.reg)[XG_DMAC_CHANNEL];
+    } else
+#endif
+    {
+        DMAC->CTRL.reg &= ~DMAC_CTRL_DMAENABLE;                                 // BASEADDR and WRBADDR can only be written while disabled
+        DMAC->BASEADDR.reg = (uint32_t)_xgDmacBase;
+        DMAC->WRBADDR.reg = (uint32_t)_xgDmacWB;
+        DMAC->CTRL.reg = DMAC_CTRL_DMAENABLE | DMAC_CTRL_LVLEN(0xF);
+        _xgDmacDesc = &_xgDmacBase[XG_DMAC_CHANNEL];
+    }
+    DMAC->CHID.reg = DMAC_CHID_ID(XG_DMAC_CHANNEL);
+    DMAC->CHCTRLA.reg &= ~DMAC_CHCTRLA_ENABLE;
+    DMAC->CHCTRLA.reg = DMAC_CHCTRLA_SWRST;
+    while (DMAC->CHCTRLA.reg & DMAC_CHCTRLA_SWRST);
+    DMAC->CHCTRLB.reg = DMAC_CHCTRLB_LVL(0) | DMAC_CHCTRLB_TRIGSRC(SERCOM1_DMAC_ID_TX) | DMAC_CHCTRLB_TRIGACT_BEAT;
+    _xgDmacOwner = this;
+    NVIC_EnableIRQ(DMAC_IRQn);
+}
+
+/******************************************************************************/
+/*! PRIVATE
+		Start a DMA transfer to the SPI bus (CS must be low already)
+		Parameters:
+		buf: the data, must stay valid until the transfer is finished
+		len: number of bytes (max XG_DMAC_CHAIN * XG_DMAC_MAX_BLOCK)
+		irq: true = call XG_DMAC_Handler() when finished
+		Returns false if len is too large
+*/
+/******************************************************************************/
+bool XGLCD::_dmacStart(const uint8_t *buf, uint32_t len, bool irq)
+{
+    DmacDescriptor *d = _xgDmacDesc;
+    uint32_t chunk;
+    uint8_t n = 0;
+    
+    if (len == 0 || len > (uint32_t)XG_DMAC_CHAIN * XG_DMAC_MAX_BLOCK) return false;
+    while (len) {
+        chunk = len > XG_DMAC_MAX_BLOCK ? XG_DMAC_MAX_BLOCK : len;
+        d->BTCTRL.reg = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BLOCKACT_NOACT | DMAC_BTCTRL_BEATSIZE_BYTE | DMAC_BTCTRL_SRCINC;
+        d->BTCNT.reg = chunk;
+        d->SRCADDR.reg = (uint32_t)buf + chunk;                                 // Source increments: end address
+        d->DSTADDR.reg = (uint32_t)&SERCOM1->SPI.DATA.reg;
+        buf += chunk;
+        len -= chunk;
+        if (len) {
+            d->DESCADDR.reg = (uint32_t)&_xgDmacChain[n];
+            d = &_xgDmacChain[n++];
+        } else {
+            d->DESCADDR.reg = 0;
+        }
+    }
+    if (irq) d->BTCTRL.reg |= DMAC_BTCTRL_BLOCKACT_INT;                         // Last block sets TCMPL
+    DMAC->CHID.reg = DMAC_CHID_ID(XG_DMAC_CHANNEL);
+    DMAC->CHINTFLAG.reg = DMAC_CHINTFLAG_TCMPL | DMAC_CHINTFLAG_TERR | DMAC_CHINTFLAG_SUSP;
+    if (irq) DMAC->CHINTENSET.reg = DMAC_CHINTENSET_TCMPL; else DMAC->CHINTENCLR.reg = DMAC_CHINTENCLR_TCMPL;
+    DMAC->CHCTRLA.reg |= DMAC_CHCTRLA_ENABLE;
+    return true;
+}
+
+/******************************************************************************/
+/*! PRIVATE
+		Wait until the DMA transfer and the last SPI byte are finished
+*/
+/******************************************************************************/
+void XGLCD::_dmacWait(void)
+{
+    DMAC->CHID.reg = DMAC_CHID_ID(XG_DMAC_CHANNEL);
+    while (DMAC->CHCTRLA.reg & DMAC_CHCTRLA_ENABLE);                            // Disabled by the DMAC after the last descriptor
+    while (SERCOM1->SPI.INTFLAG.bit.TXC == 0);
+    while (SERCOM1->SPI.INTFLAG.bit.RXC) (void)SERCOM1->SPI.DATA.reg;           // Drop received data
+    SERCOM1->SPI.STATUS.bit.BUFOVF = 1;
+}
+
+/******************************************************************************/
+/*! PRIVATE
+		Blocking DMA write to the SPI bus (CS must be low already)
+		Parameters:
+		buf: the data
+		len: number of bytes
+		swap16: true = swap the bytes of every 16 bit word (high byte first)
+		The swapped data is copied into a ping-pong buffer while the previous
+		part is being send
+*/
+/******************************************************************************/
+void XGLCD::_dmacWrite(const uint8_t *buf, uint32_t len, bool swap16)
+{
+    uint32_t chunk, i;
+    uint8_t s = 0;
+    bool running = false;
+    
+    if (!swap16) {
+        while (len) {
+            chunk = (uint32_t)XG_DMAC_CHAIN * XG_DMAC_MAX_BLOCK;
+            if (chunk > len) chunk = len;
+            _dmacStart(buf, chunk, false);
+            _dmacWait();
+            buf += chunk;
+            len -= chunk;
+        }
+        return;
+    }
+    while (len) {
+        chunk = len > XG_DMAC_STAGE ? XG_DMAC_STAGE : len;
+        for (i=0; i<chunk; i+=2) {
+            _dmacStage[s][i] = buf[i+1];
+            _dmacStage[s][i+1] = buf[i];
+        }
+        if (running) {
+            DMAC->CHID.reg = DMAC_CHID_ID(XG_DMAC_CHANNEL);
+            while (DMAC->CHCTRLA.reg & DMAC_CHCTRLA_ENABLE);
+        }
+        _dmacStart(_dmacStage[s], chunk, false);
+        running = true;
+        buf += chunk;
+        len -= chunk;
+        s ^= 1;
+    }
+    if (running) _dmacWait();
+}
+
+/******************************************************************************/
+/*!
+		DMAC interrupt: end of a drawBitmapAsync transfer
+		Only our channel is handled, the channel selection (CHID) is restored
+*/
+/******************************************************************************/
+void XG_DMAC_Handler(void)
+{
+    XGLCD *lcd = _xgDmacOwner;
+    void (*cb)(void);
+    uint8_t chid = DMAC->CHID.reg;
+    
+    DMAC->CHID.reg = DMAC_CHID_ID(XG_DMAC_CHANNEL);
+    if (!(DMAC->CHINTFLAG.reg & DMAC_CHINTFLAG_TCMPL)) {
+        DMAC->CHID.reg = chid;
+        return;
+    }
+    DMAC->CHINTFLAG.reg = DMAC_CHINTFLAG_TCMPL;
+    DMAC->CHINTENCLR.reg = DMAC_CHINTENCLR_TCMPL;
+    DMAC->CHID.reg = chid;
+    if (lcd == NULL) return;
+    while (SERCOM1->SPI.INTFLAG.bit.TXC == 0);
+    while (SERCOM1->SPI.INTFLAG.bit.RXC) (void)SERCOM1->SPI.DATA.reg;
+    SERCOM1->SPI.STATUS.bit.BUFOVF = 1;
+    _spiCSHigh;
+    cb = lcd->_dmaCallback;
+    lcd->_dmaCallback = NULL;
+    lcd->_dmaBusy = false;
+    if (cb) cb();                                                               // May start the next transfer
+}
+
+#if !defined(XG_DMAC_SHARED)
+void DMAC_Handler(void)
+{
+    XG_DMAC_Handler();
+}
+#endif
+#endif
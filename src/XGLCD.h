@@ -68,6 +68,15 @@ WARNING: SD.begin(XG_SD_CS) MUST be added AFTER tft.begin()
 // #define XG_LCD_50             // 5.0" 800x480 LCD
 // #define XG_LCD_56             // 5.6" 640x480 LCD
 // #define XG_LCD_90             // 9.0" 800x480 LCD
+// Arduino MKR: bitmaps are send with the DMA controller (DMAC channel XG_DMAC_CHANNEL, default 0). If another
+// library uses the DMAC too, enable XG_DMAC_SHARED and select a channel it does not use (begin the other library
+// first, its DMAC_Handler() must call XG_DMAC_Handler()), or disable the DMAC with XG_MKR_NO_DMA
+// #define XG_MKR_NO_DMA         // Use CPU loops instead of the DMAC
+// #define XG_DMAC_SHARED        // Use the descriptor table and DMAC_Handler() of another library
+// #define XG_DMAC_CHANNEL 4     // DMAC channel used for the SPI transfers
+// Count the SPI traffic (bytes, CS cycles, speed switches, busy polls, time) per public XGLCD function,
+// see XGSpiProfile.h for the report
+// #define XG_SPI_PROFILE
 /* END OF USER DEFINES ************************************************************************************/
 
 
@@ -77,6 +86,8 @@ WARNING: SD.begin(XG_SD_CS) MUST be added AFTER tft.begin()
 
 #include <stdio.h>
 //XG// #include "Print.h"
+#include "XGDisplayList.h"
+#include "XGTrig.h"
 
 #if defined(_FORCE_PROGMEM__)                                                   // Disable PROGMEM which is not needed on 32-bit CPU's with a lot of RAM
     #undef _FORCE_PROGMEM__
@@ -93,7 +104,8 @@ WARNING: SD.begin(XG_SD_CS) MUST be added AFTER tft.begin()
 #endif
 
 // CPU module auto-detection based on the user selected board type in the Arduino IDE
-#if defined(ARDUINO_ARCH_SAMD)                                                  // Arduino MKR family (and all other SAMD modules, but only the MKR will work)
+#if defined(XG_CPU_HOST)                                                        // Host (PC) build against the RA8875 model in src/host, define XG_CPU_HOST on the compiler command line
+#elif defined(ARDUINO_ARCH_SAMD)                                                  // Arduino MKR family (and all other SAMD modules, but only the MKR will work)
     #define XG_CPU_MKR
 #elif defined(ARDUINO_ESP32_DEV)                                                // ESP32 Development Kit C / Pycom modules (without Python of course)
 // Pycom modules (the latest only) have 8Mbit Flash and 4Mbit PSRAM
@@ -131,19 +143,38 @@ WARNING: SD.begin(XG_SD_CS) MUST be added AFTER tft.begin()
 
     //#define _spiwrite(c)                    _writeMKRSPI(c)
     //#define _spiwrite16(d)                  _writeMKRSPI16(d)
-    #define _spiwrite(c)                    {SERCOM1->SPI.DATA.bit.DATA = c;while(SERCOM1->SPI.INTFLAG.bit.TXC == 0);}
-    #define _spiwrite16(c)                  {SERCOM1->SPI.DATA.bit.DATA = c>>8;SERCOM1->SPI.DATA.bit.DATA = c & 0xff;while(SERCOM1->SPI.INTFLAG.bit.TXC == 0);}
-    #define _spiwritedma(wbuf, length)      {uint16_t i;for (i=0; i<length; i++) {while(SERCOM1->SPI.INTFLAG.bit.DRE == 0);SERCOM1->SPI.DATA.bit.DATA = buf[i];}while(SERCOM1->SPI.INTFLAG.bit.TXC == 0);}
+    #define _spiwrite(c)                    {_XGP_TX(1);SERCOM1->SPI.DATA.bit.DATA = c;while(SERCOM1->SPI.INTFLAG.bit.TXC == 0);}
+    #define _spiwrite16(c)                  {_XGP_TX(2);SERCOM1->SPI.DATA.bit.DATA = c>>8;SERCOM1->SPI.DATA.bit.DATA = c & 0xff;while(SERCOM1->SPI.INTFLAG.bit.TXC == 0);}
+#if defined(XG_MKR_NO_DMA)
+    #define _spiwritedma(wbuf, length)      {_XGP_TX((uint32_t)(length)*2);uint32_t i;const uint8_t *b = (const uint8_t *)(wbuf);for (i=0; i<(uint32_t)(length)*2; i++) {while(SERCOM1->SPI.INTFLAG.bit.DRE == 0);SERCOM1->SPI.DATA.bit.DATA = b[i];}while(SERCOM1->SPI.INTFLAG.bit.TXC == 0);}
+#else
+    // DMAC channel SERCOM1 TX, pixels are send in memory order (same as the ESP32 DMA) or high byte first (swap)
+#ifndef XG_DMAC_CHANNEL
+    #define XG_DMAC_CHANNEL                 0
+#endif
+#if defined(XG_DMAC_SHARED) && XG_DMAC_CHANNEL == 0
+    #error "XG_DMAC_SHARED: define XG_DMAC_CHANNEL as a DMAC channel the other library does not use (they allocate from 0)"
+#endif
+    #define XG_DMAC_MAX_BLOCK               65535                               // BTCNT is 16 bit
+    #define XG_DMAC_CHAIN                   16                                  // Descriptors per transfer: 16 * 64kB covers a full 800x480 screen
+    #define XG_DMAC_STAGE                   512                                 // Byte swap staging buffer (x2, ping-pong), one DMA start per 256 pixels
+    #define _spiwritedma(wbuf, length)      (_XGP_TX((uint32_t)(length)*2), _dmacWrite((const uint8_t *)(wbuf), (uint32_t)(length)*2, false))
+    #define _spiwritedmaswap(wbuf, length)  (_XGP_TX((uint32_t)(length)*2), _dmacWrite((const uint8_t *)(wbuf), (uint32_t)(length)*2, true))
+    extern "C" void DMAC_Handler(void);
+    extern "C" void XG_DMAC_Handler(void);
+#endif
 
-    #define _spiread(r)                     r = SPI.transfer(0x00);
+    #define _spiread(r)                     r = (_XGP_RX(1), SPI.transfer(0x00));
     #define _spibegin()                     SPI.begin()
     #define _spisetDataMode(datamode)       SPI.setDataMode(datamode)
     #define _spisetBitOrder(order)          SPI.setBitOrder(order)
-    #define _spisetSpeed(s)                 SPI.setClockDivider(s)
+    #define _spisetSpeed(s)                 (_XGP_SPEED, SPI.setClockDivider(s))
 
-    #define _spiCSLow                       PORT->Group[g_APinDescription[XG_PIN_LCD_CS].ulPort].OUTCLR.reg = (1UL << g_APinDescription[XG_PIN_LCD_CS].ulPin)
+    #define _spiCSLow                       (_XGP_CS, PORT->Group[g_APinDescription[XG_PIN_LCD_CS].ulPort].OUTCLR.reg = (1UL << g_APinDescription[XG_PIN_LCD_CS].ulPin))
     #define _spiCSHigh                      PORT->Group[g_APinDescription[XG_PIN_LCD_CS].ulPort].OUTSET.reg = (1UL << g_APinDescription[XG_PIN_LCD_CS].ulPin)
 
+    #define _cpuIdle()                      __WFI()                             // Sleep until the next interrupt (SysTick at the latest)
+
     //LED = 6 (LED_BUILTIN)
     #define XG_PIN_BL (0u)
     #define XG_PIN_DC (1u)
@@ -178,6 +209,7 @@ WARNING: SD.begin(XG_SD_CS) MUST be added AFTER tft.begin()
     #include "soc/spi_struct.h"
     #include "driver/spi_common.h"
     #include "soc/dport_reg.h"
+    #include "esp_intr_alloc.h"
 
     #define SPI_SPEED_WRITE                 20000000
     #define SPI_SPEED_READ                  4000000
@@ -194,37 +226,49 @@ WARNING: SD.begin(XG_SD_CS) MUST be added AFTER tft.begin()
     #define _spisetSpeed                    SPI.setFrequency(_spi_speed)
 */
     #define _spiwrite(c)                    {\
+                                            _XGP_TX(1);_XGP_CS;\
                                             dev->mosi_dlen.usr_mosi_dbitlen = 7;\
                                             dev->data_buf[0] = c;\
                                             dev->cmd.usr = 1;\
                                             while(dev->cmd.usr);\
                                             }
     #define _spiwrite16(d)                  {\
+                                            _XGP_TX(2);_XGP_CS;\
                                             dev->mosi_dlen.usr_mosi_dbitlen = 15;\
                                             dev->data_buf[0] = ((d) >> 8) | ((d) << 8);\
                                             dev->cmd.usr = 1;\
                                             while(dev->cmd.usr);\
                                             }
+    // Stream n 16 bit frames, each in its own (hardware) CS cycle, bit length is set only once
+    #define _spiburst16(w, n)               {\
+                                            dev->mosi_dlen.usr_mosi_dbitlen = 15;\
+                                            for (uint8_t _i=0; _i<(n); _i++) {\
+                                                _XGP_TX(2);_XGP_CS;\
+                                                dev->data_buf[0] = ((w)[_i] >> 8) | ((w)[_i] << 8);\
+                                                dev->cmd.usr = 1;\
+                                                while(dev->cmd.usr);\
+                                            }\
+                                            }
     #define _spiwrite24(r,d)                {\
+                                            _XGP_TX(3);_XGP_CS;\
                                             dev->mosi_dlen.usr_mosi_dbitlen = 23;\
-                                            dev->data_buf[0] = ((d) && 0xff00) | ((d) << 16) | r;\
+                                            dev->data_buf[0] = ((d) & 0xff00) | ((d) << 16) | r;\
                                             dev->cmd.usr = 1;\
                                             while(dev->cmd.usr);\
                                             }
     // LittleVGL supports a double buffer with the LV_VDB_DOUBLE macro and DMA support
-    // BUT, this requires a call to lv_flush_ready() when the SPI DMA transfer is finished, and that requires an interrupt routine
-    // For now, that is not supported in this class (mixing C/C++ code), so double buffering is disabled
-    // Note that the expected speed profit is limited because the display frame calculation is rather fast on an ESP32
-    #define _spixwritedma(c, wbuf, len)     {\
+    // This requires a call to lv_flush_ready() when the SPI DMA transfer is finished: use drawBitmapAsync()
+    // _spixstartdma only starts the transfer, cbuf must stay valid until the transfer is finished
+    #define _spixstartdma(cbuf, wbuf, len)  {\
+                                            _XGP_TX(1 + (uint32_t)(len)*2);_XGP_CS;\
                                             dev->dma_conf.val |= SPI_OUT_RST|SPI_IN_RST|SPI_AHBM_RST|SPI_AHBM_FIFO_RST;\
                                             dev->dma_out_link.start=0;\
                                             dev->dma_conf.val &= ~(SPI_OUT_RST|SPI_IN_RST|SPI_AHBM_RST|SPI_AHBM_FIFO_RST);\
                                             uint32_t n=0;\
-                                            uint8_t cmd = c;\
                                             dmadesc[n].size = 1;\
                                             dmadesc[n].length = 1;\
                                             dmadesc[n].eof = 0;\
-                                            dmadesc[n].buf = (uint8_t *)&cmd;\
+                                            dmadesc[n].buf = (uint8_t *)(cbuf);\
                                             dmadesc[n].qe.stqe_next = &dmadesc[n+1];\
                                             n++;\
                                             len *=2;\
@@ -247,10 +291,17 @@ WARNING: SD.begin(XG_SD_CS) MUST be added AFTER tft.begin()
                                             dev->dma_out_link.start=1;\
                                             dev->user.usr_miso=0;\
                                             dev->cmd.usr = 1;\
+                                            }
+    #define _spixwritedma(c, wbuf, len)     {\
+                                            uint8_t cmd = c;\
+                                            _spixstartdma(&cmd, wbuf, len);\
                                             while(dev->cmd.usr);\
                                             }
+    // Pixel conversion (byte swap, RGB332) staging buffer, send with one DMA transaction per XG_SPI_STAGE bytes
+    #define XG_SPI_STAGE                    512
     // delayMicroseconds(50); is removed: TBC
     #define _spixread(x, r)                 {\
+                                            _XGP_TX(1);_XGP_RX(1);_XGP_CS;\
                                             dev->mosi_dlen.usr_mosi_dbitlen = 15;\
                                             dev->data_buf[0] = x;\
                                             dev->cmd.usr = 1;\
@@ -258,6 +309,7 @@ WARNING: SD.begin(XG_SD_CS) MUST be added AFTER tft.begin()
                                             r = dev->data_buf[0] >> 8;\
                                             }
     #define _spixbread(x, r, b)             {\
+                                            _XGP_TX(1);_XGP_RX((b)/8);_XGP_CS;\
                                             dev->mosi_dlen.usr_mosi_dbitlen = b-1+8;\
                                             dev->miso_dlen.usr_miso_dbitlen = b-1+8;\
                                             dev->data_buf[0] = x;\
@@ -267,10 +319,22 @@ WARNING: SD.begin(XG_SD_CS) MUST be added AFTER tft.begin()
                                             r = (dev->data_buf[0]>>8) + (dev->data_buf[1]<<24);\
                                             dev->miso_dlen.usr_miso_dbitlen = 15;\
                                             }
+    // Read n bytes (max 60) after command x, a memory read continues in the next transaction
+    #define _spixreadbuf(x, buf, n)         {\
+                                            _XGP_TX(1);_XGP_RX(n);_XGP_CS;\
+                                            dev->mosi_dlen.usr_mosi_dbitlen = (n)*8-1+8;\
+                                            dev->miso_dlen.usr_miso_dbitlen = (n)*8-1+8;\
+                                            dev->data_buf[0] = x;\
+                                            for (uint8_t _i=1; _i<16; _i++) dev->data_buf[_i] = 0;\
+                                            dev->cmd.usr = 1;\
+                                            while(dev->cmd.usr);\
+                                            for (uint8_t _i=0; _i<(n); _i++) (buf)[_i] = dev->data_buf[(_i+1)>>2] >> (((_i+1)&3)*8);\
+                                            dev->miso_dlen.usr_miso_dbitlen = 15;\
+                                            }
     #define _spibegin()                     {SPI.begin();}
     #define _spisetDataMode(datamode)       SPI.setDataMode(datamode)
     #define _spisetBitOrder(order)          SPI.setBitOrder(order)
-    #define _spisetSpeed(s)                 SPI.setFrequency(s)
+    #define _spisetSpeed(s)                 (_XGP_SPEED, SPI.setFrequency(s))
     #define _spisetBitLen                   {\
                                             SPI.setHwCs(true);\
                                             dev->mosi_dlen.usr_mosi_dbitlen = 15;\
@@ -297,6 +361,8 @@ WARNING: SD.begin(XG_SD_CS) MUST be added AFTER tft.begin()
     //#define _spiCSLow                       GPIO.out_w1tc = 0x20
     //#define _spiCSHigh                      GPIO.out_w1ts = 0x20
 
+    #define _cpuIdle()                      yield()                             // Let the other FreeRTOS tasks run
+
     #define XG_PIN_BL 17
     #define XG_PIN_DC 16
     #define XG_PIN_LCD_RESET 34
@@ -324,27 +390,29 @@ WARNING: SD.begin(XG_SD_CS) MUST be added AFTER tft.begin()
     #define XG_PIN_A2 A15
 
 #elif defined(XG_CPU_PARTICLE)                                                  // Particle Family, this library should be used in the Particle IDE not in the Arduino IDE
-3
     #include <Arduino.h>
     #define SPI_SPEED_WRITE                 SPI_CLOCK_DIV4                      // 15 MHz (divider /6 does not work) (SPI base clock = CPU clock / 2)
     #define SPI_SPEED_READ                  SPI_CLOCK_DIV16                     // 3.75MHz / Theoretical: 7.5 MHz @ 120MHz CPU clock
     #define SPI_SPEED_SLOW                  SPI_CLOCK_DIV32                     // must be slower then 2 MHz before PLL is configured -> 1.82MHz @ 120MHz CPU clock
     #define SPI_MODE_LCD                    SPI_MODE3
 
-    #define _spiwrite(c)                    SPI.transfer(c)
-    #define _spiwrite16(d)                  {SPI.transfer(d >> 8);SPI.transfer(d & 0xFF);}
-    #define _spiwritedma(wbuf, length)      SPI.transfer(wbuf, NULL, length, NULL);
+    #define _spiwrite(c)                    (_XGP_TX(1), SPI.transfer(c))
+    #define _spiwrite16(d)                  {_XGP_TX(2);SPI.transfer(d >> 8);SPI.transfer(d & 0xFF);}
+    #define _spiwritedma(wbuf, length)      (_XGP_TX((uint32_t)(length)*2), SPI.transfer((void *)(wbuf), NULL, (uint32_t)(length)*2, NULL))
+    // Block writes: pixels are converted into a staging buffer of XG_SPI_STAGE bytes, which is send with one DMA transfer
+    #define XG_SPI_STAGE                    256
+    #define _spiwritebuf(buf, n)            (_XGP_TX(n), SPI.transfer(buf, NULL, n, NULL))
 
-    #define _spiread(r)                     r = SPI.transfer(0x00);
+    #define _spiread(r)                     r = (_XGP_RX(1), SPI.transfer(0x00));
     #define _spibegin()                     SPI.begin()
     //#if defined(SPARK) (TO BE FIXED, after testing with Particle parts)
     //    if (datamode == SPI_MODE3) datamode = SPI_MODE0;
     //#endif
     #define _spisetDataMode(datamode)       SPI.setDataMode(datamode)
     #define _spisetBitOrder(order)          SPI.setBitOrder(order)
-    #define _spisetSpeed(s)                 SPI.setClockDivider(s)
+    #define _spisetSpeed(s)                 (_XGP_SPEED, SPI.setClockDivider(s))
 
-    #define _spiCSLow                       pinResetFast(XG_PIN_LCD_CS)
+    #define _spiCSLow                       (_XGP_CS, pinResetFast(XG_PIN_LCD_CS))
     #define _spiCSHigh                      pinSetFast(XG_PIN_LCD_CS)
 
     #define LED_BUILTIN D7                                                      //Shared with BL
@@ -376,7 +444,6 @@ WARNING: SD.begin(XG_SD_CS) MUST be added AFTER tft.begin()
     //#define XG_PIN_A2
 
 #elif defined(XG_CPU_FANSTEL)                                                   // Fanstel module
-4
     #include <Arduino.h>
     #include <SPI_RF.h>
     #define SPI_SPEED_WRITE                 SPI_8M                              // 8 MHz // SPI_8M is defined but 8MHz is out-of-spec for the nRF51822, is it ?
@@ -384,17 +451,17 @@ WARNING: SD.begin(XG_SD_CS) MUST be added AFTER tft.begin()
     #define SPI_SPEED_SLOW                  SPI_2M                              // must be slower then 2 MHz before PLL is configured
     #define SPI_MODE_LCD                    SPI_MODE2
 
-    #define _spiwrite(c)                    SPI_RF.write(c)
-    #define _spiwrite16(d)                  SPI_RF.write16(d)
-    #define _spiwritedma(wbuf, length)      SPI_RF.write(wbuf, length)
+    #define _spiwrite(c)                    (_XGP_TX(1), SPI_RF.write(c))
+    #define _spiwrite16(d)                  (_XGP_TX(2), SPI_RF.write16(d))
+    #define _spiwritedma(wbuf, length)      (_XGP_TX((uint32_t)(length)*2), SPI_RF.write(wbuf, (uint32_t)(length)*2))
 
-    #define _spiread(r)                     r = SPI_RF.transfer(0x00);
+    #define _spiread(r)                     r = (_XGP_RX(1), SPI_RF.transfer(0x00));
     #define _spibegin()                     SPI_RF.begin()
     #define _spisetDataMode(datamode)       SPI_RF.setSPIMode(datamode)
     #define _spisetBitOrder(order)          SPI_RF.setBitORDER(order)
-    #define _spisetSpeed(s)                 SPI_RF.setFrequency(s)
+    #define _spisetSpeed(s)                 (_XGP_SPEED, SPI_RF.setFrequency(s))
 
-    #define _spiCSLow                       NRF_GPIO->OUTCLR = (1ul << P0_10)
+    #define _spiCSLow                       (_XGP_CS, NRF_GPIO->OUTCLR = (1ul << P0_10))
     #define _spiCSHigh                      NRF_GPIO->OUTSET = (1ul << P0_10)
     /*
      #define SS XG_PIN_LCD_CS                                                    // needed for SdFat
@@ -441,7 +508,6 @@ WARNING: SD.begin(XG_SD_CS) MUST be added AFTER tft.begin()
     //#define XG_PIN_A2
 
 #elif defined(XG_CPU_ARDUINO)                                                   // All other boards presume the Arduino headers are used, 32-bit boards work better, generic SPI commands are used
-5
     #include <Arduino.h>
     #include <SPI.h>
 
@@ -450,16 +516,21 @@ WARNING: SD.begin(XG_SD_CS) MUST be added AFTER tft.begin()
     #define SPI_SPEED_SLOW                  SPI_CLOCK_DIV8                      // 2MHz
     #define SPI_MODE_LCD                    SPI_MODE3
 
-    #define _spiwrite(c)                    SPI.transfer(c)
-    #define _spiwrite16(d)                  SPI.transfer16(d)
+    #define _spiwrite(c)                    (_XGP_TX(1), SPI.transfer(c))
+    #define _spiwrite16(d)                  (_XGP_TX(2), SPI.transfer16(d))
+    #define _spiwritedma(wbuf, length)      {_XGP_TX((uint32_t)(length)*2);const uint8_t *_b = (const uint8_t *)(wbuf);for (uint32_t _i=0; _i<(uint32_t)(length)*2; _i++) SPI.transfer(_b[_i]);}
+    // Block writes: pixels are converted into a staging buffer of XG_SPI_STAGE bytes, which is send with one
+    // SPI.transfer call (the buffer is overwritten with the received bytes)
+    #define XG_SPI_STAGE                    64
+    #define _spiwritebuf(buf, n)            (_XGP_TX(n), SPI.transfer(buf, n))
 
-    #define _spiread(r)                     r = SPI.transfer(0x00);
+    #define _spiread(r)                     r = (_XGP_RX(1), SPI.transfer(0x00));
     #define _spibegin()                     SPI.begin()
     #define _spisetDataMode(datamode)       SPI.setDataMode(datamode)
     #define _spisetBitOrder(order)          SPI.setBitOrder(order)
-    #define _spisetSpeed(s)                 setClockDivider(s)
+    #define _spisetSpeed(s)                 (_XGP_SPEED, SPI.setClockDivider(s))
 
-    #define _spiCSLow                       digitalWrite(XG_PIN_LCD_CS, LOW)
+    #define _spiCSLow                       (_XGP_CS, digitalWrite(XG_PIN_LCD_CS, LOW))
     #define _spiCSHigh                      digitalWrite(XG_PIN_LCD_CS, HIGH)
 
     #define XG_PIN_BL (8)
@@ -467,16 +538,77 @@ WARNING: SD.begin(XG_SD_CS) MUST be added AFTER tft.begin()
     #define XG_PIN_LCD_RESET (9)
     #define XG_PIN_SD_CS (5)
     #define XG_PIN_TP_CS (6)
-    #define XG_PIN_TP_IRQ(4)
+    #define XG_PIN_TP_IRQ (4)
     #define XG_PIN_LCD_CS PIN_SPI_SS
     #define XG_PIN_MOSI PIN_SPI_MOSI
     #define XG_PIN_MISO PIN_SPI_MISO
     #define XG_PIN_SCK PIN_SPI_SCK
 
+#elif defined(XG_CPU_HOST)                                                      // Host (PC) build: no panel, RA8875 model (see host/XGHost.h)
+
+    #include "host/XGHost.h"
+
+    #define SPI_SPEED_WRITE                 20000000                            // Hz, used for the virtual clock of the model
+    #define SPI_SPEED_READ                  4000000
+    #define SPI_SPEED_SLOW                  2000000
+    #define SPI_MODE_LCD                    SPI_MODE3
+
+    #define _spiwrite(c)                    (_XGP_TX(1), xgHost.transfer(c))
+    #define _spiwrite16(d)                  (_XGP_TX(2), xgHost.write16(d))
+    #define _spiwritedma(wbuf, length)      (_XGP_TX((uint32_t)(length)*2), xgHost.writeBytes((const uint8_t *)(wbuf), (uint32_t)(length)*2))
+    #define _spiwritedmaswap(wbuf, length)  (_XGP_TX((uint32_t)(length)*2), xgHost.writeSwapped((const uint16_t *)(wbuf), length))
+    #define XG_SPI_STAGE                    256
+    #define _spiwritebuf(buf, n)            (_XGP_TX(n), xgHost.writeBytes(buf, n))
+
+    #define _spiread(r)                     r = (_XGP_RX(1), xgHost.transfer(0x00));
+    #define _spibegin()                     xgHost.begin()
+    #define _spisetDataMode(datamode)
+    #define _spisetBitOrder(order)
+    #define _spisetSpeed(s)                 (_XGP_SPEED, xgHost.setSpeed(s))
+
+    #define _spiCSLow                       (_XGP_CS, xgHost.csLow())
+    #define _spiCSHigh                      xgHost.csHigh()
+
+    #define _cpuIdle()                      delayMicroseconds(1)                // Advance the virtual clock
+
+    #define XG_PIN_BL (8)
+    #define XG_PIN_DC (7)
+    #define XG_PIN_LCD_RESET (9)
+    #define XG_PIN_SD_CS (5)
+    #define XG_PIN_TP_CS (6)
+    #define XG_PIN_TP_IRQ (4)
+    #define XG_PIN_LCD_CS (10)
+    #define XG_PIN_MOSI (11)
+    #define XG_PIN_MISO (12)
+    #define XG_PIN_SCK (13)
+
 #else                                                                           // Safeguard, should never occur
     #error "Your CPU board is not supported on your X-Graph LCD module."
 #endif
 
+// SPI traffic profiler hooks, used in the SPI macro's above and in the low level XGLCD functions
+// _XGP_SCOPE attributes the traffic to the public function it is placed in
+#if defined(XG_SPI_PROFILE)
+    #include "XGSpiProfile.h"
+    #define _XGP_TX(n)                      (xgSpiProfile.cur->txBytes += (n))
+    #define _XGP_RX(n)                      (xgSpiProfile.cur->rxBytes += (n))
+    #define _XGP_CS                         (xgSpiProfile.cur->csCycles++)
+    #define _XGP_SPEED                      (xgSpiProfile.cur->speedSwitches++)
+    #define _XGP_POLL                       (xgSpiProfile.cur->busyPolls++)
+    #define _XGP_REG                        (xgSpiProfile.cur->regWrites++)
+    #define _XGP_CMD                        (xgSpiProfile.cur->commands++)
+    #define _XGP_SCOPE                      XGSpiScope _xgpScope(__func__)
+#else
+    #define _XGP_TX(n)                      ((void)0)
+    #define _XGP_RX(n)                      ((void)0)
+    #define _XGP_CS                         ((void)0)
+    #define _XGP_SPEED                      ((void)0)
+    #define _XGP_POLL                       ((void)0)
+    #define _XGP_REG                        ((void)0)
+    #define _XGP_CMD                        ((void)0)
+    #define _XGP_SCOPE                      ((void)0)
+#endif
+
 // Macro's to abstract the Serial object (usefull to easily disable serial/debugging output)
 #define Sbegin(a) Serial.begin(a);
 #define Sprintln(a) Serial.println(a)
@@ -524,6 +656,7 @@ WARNING: SD.begin(XG_SD_CS) MUST be added AFTER tft.begin()
 #define ARC_ANGLE_MAX                   360
 #define ARC_ANGLE_OFFSET                -90
 #define ANGLE_OFFSET                    -90
+#define XG_CLIP_STACK                   4                                       // saved clip rectangles (pushClipRect)
 
 
 //++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
@@ -730,6 +863,8 @@ WARNING: SD.begin(XG_SD_CS) MUST be added AFTER tft.begin()
  10: Top -> Down then Left -> Right
  11: Down -> Top then Left -> Right */
 #define RA8875_MRCD                     0x45                                    //Memory Read Cursor Direction
+#define RA8875_MRCD_LT                  0x00
+#define RA8875_MRCD_TL                  0x02
 #define RA8875_CURH0                    0x46                                    //Memory Write Cursor Horizontal Position Register 0
 #define RA8875_CURH1                    0x47                                    //Memory Write Cursor Horizontal Position Register 1
 #define RA8875_CURV0                    0x48                                    //Memory Write Cursor Vertical Position Register 0
@@ -1075,6 +1210,7 @@ WARNING: SD.begin(XG_SD_CS) MUST be added AFTER tft.begin()
 #define RA8875_INTCx_DMA                0x08
 #define RA8875_INTCx_TP                 0x04
 #define RA8875_INTCx_BTE                0x02
+#define RA8875_INTCx_FONT               0x01                                    //BTE MCU R/W or font write (BTE disabled)
 
 #define RA8875_ENABLE_INT_TP            ((uint8_t)(1<<2))
 #define RA8875_DISABLE_INT_TP           ((uint8_t)(0<<2))
@@ -1233,6 +1369,37 @@ typedef struct {
     bool            rle;
 } tFont;
 
+// Palette image for drawIndexed (see extras/tools/xg_indexed.py)
+// Every line starts on a byte boundary, the first pixel is in the high bits of a byte
+typedef struct {
+    uint16_t        width;
+    uint16_t        height;
+    uint8_t         bits;                                                       // bits per pixel: 1, 2, 4 or 8
+    uint16_t        colors;                                                     // palette entries, 0 = 1 << bits
+    const uint16_t  *palette;                                                   // RGB565
+    const uint8_t   *data;                                                      // packed indices
+} tIndexedImage;
+
+// Shapes for the batched primitives (fillRects, drawLines, plotPoints)
+typedef struct {
+    int16_t         x;
+    int16_t         y;
+    int16_t         w;
+    int16_t         h;
+} tRect;
+
+typedef struct {
+    int16_t         x0;
+    int16_t         y0;
+    int16_t         x1;
+    int16_t         y1;
+} tSegment;
+
+typedef struct {
+    int16_t         x;
+    int16_t         y;
+} tPoint;
+
 #if !defined(swapvals)
     #define swapvals(a, b) { typeof(a) t = a; a = b; b = t; }
 #endif
@@ -1266,6 +1433,7 @@ class XGLCD : public Print {
 #if defined(XG_CPU_ESP32)
     spi_dev_t * dev = (volatile spi_dev_t *)(DR_REG_SPI3_BASE);                 // VSPI = SPI3 = default SPI port
     lldesc_t dmadesc[32];                                                       // max dma size = 32 * 4096 words = 128kByte
+    intr_handle_t dmaIntr;                                                      // SPI transfer done interrupt (drawBitmapAsync)
 #endif
     
     // Windows
@@ -1279,14 +1447,17 @@ class XGLCD : public Print {
     void        setRotation(uint8_t rotation);
     uint8_t     getRotation();
     boolean     isPortrait(void);
-    //void         getPixels(uint16_t * p, uint32_t count, int16_t x, int16_t y);
     
     // Graphic primitives
     void        drawPixel(int16_t x, int16_t y);
     void        drawPixel(int16_t x, int16_t y, uint16_t color);
     void        _drawPixel(int16_t x, int16_t y, uint16_t color);
     void        drawPixels(uint16_t p[], uint32_t count, int16_t x, int16_t y);
+    void        drawPixels8(const uint8_t p[], uint32_t count, int16_t x, int16_t y);
     uint16_t    getPixel(int16_t x, int16_t y);
+    void        getPixels(uint16_t * p, uint32_t count, int16_t x, int16_t y);
+    void        readRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t *dst);
+    void        captureScreen(Print &out, int8_t layer=-1);
     void        pushPixels(uint32_t num, uint16_t p);
     void        fillWindow(uint16_t color=COLOR_BLACK);
     void        clearScreen(uint16_t color=COLOR_BLACK);
@@ -1303,6 +1474,11 @@ class XGLCD : public Print {
     void        drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
     void        fillRect(int16_t x0, int16_t y0, int16_t x1, int16_t y1);
     void        fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void        fillRects(const tRect *rects, uint16_t n, uint16_t color);
+    void        fillRects(const tRect *rects, uint16_t n, const uint16_t *colors);
+    void        drawLines(const tSegment *lines, uint16_t n, uint16_t color);
+    void        drawLines(const tSegment *lines, uint16_t n, const uint16_t *colors);
+    void        plotPoints(const tPoint *points, uint16_t n, uint16_t color);
     void        drawRoundRect(int16_t x0, int16_t y0, int16_t x1, int16_t y1);
     void        drawRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color);
     void        fillRoundRect(int16_t x0, int16_t y0, int16_t x1, int16_t y1);
@@ -1311,7 +1487,7 @@ class XGLCD : public Print {
     void        drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
     void        fillCircle(int16_t x0, int16_t y0, int16_t r);
     void        fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
-    inline __attribute__((always_inline)) void drawArc(uint16_t cx, uint16_t cy, uint16_t radius, uint16_t thickness, float start, float end, uint16_t color);
+    void        drawArc(uint16_t cx, uint16_t cy, uint16_t radius, uint16_t thickness, float start, float end, uint16_t color);
     void        setArcParams(float arcAngleMax, int arcAngleOffset);
     void        setAngleOffset(int16_t angleOffset);
     void        drawQuad(int16_t x0, int16_t y0,int16_t x1, int16_t y1,int16_t x2, int16_t y2,int16_t x3, int16_t y3, uint16_t color);
@@ -1333,7 +1509,28 @@ class XGLCD : public Print {
 
     void        drawBitmap(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t * image, uint16_t scale);
     void        drawBitmap(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t * image, uint16_t degree, uint16_t rx, uint16_t ry);
+    void        drawBitmapSmooth(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t * image, uint16_t scale);
+    void        drawBitmapSmooth(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t * image, uint16_t degree, uint16_t rx, uint16_t ry);
     void        drawBitmap(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t * image);
+    void        drawBitmap8(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, const uint8_t * image);
+    void        blit(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t * src, uint16_t stride=0);
+    void        blit(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t * src, uint16_t stride=0);
+    void        drawRLE(int16_t x, int16_t y, const uint8_t * rle);
+    void        drawIndexed(int16_t x, int16_t y, const tIndexedImage &image);
+    void        drawMono(int16_t x, int16_t y, int16_t w, int16_t h, const uint8_t * bits, uint16_t fg, uint16_t bg, bool transparent=false);
+    void        drawBitmapKeyed(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t * image, uint16_t key, uint16_t stride=0);
+    void        setClipRect(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+    void        clearClipRect(void);
+    void        pushClipRect(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+    void        popClipRect(void);
+    void        drawBitmapAsync(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t * image, void (*callback)(void)=NULL);
+    bool        isBusy(void);
+    void        waitIdle(void);
+    
+    // Display lists
+    void        beginRecording(XGDisplayList *dl);
+    void        endRecording(void);
+    void        drawList(const XGDisplayList &dl);
 
     // Text & Cursor
     void        uploadUserChar(const uint8_t symbol[],uint8_t address);
@@ -1389,6 +1586,9 @@ class XGLCD : public Print {
     inline uint16_t Color24To565(int32_t color_) { return ((((color_ >> 16) & 0xFF) / 8) << 11) | ((((color_ >> 8) & 0xFF) / 4) << 5) | (((color_) &  0xFF) / 8);}
     inline uint16_t htmlTo565(int32_t color_) { return (uint16_t)(((color_ & 0xF80000) >> 8) | ((color_ & 0x00FC00) >> 5) | ((color_ & 0x0000F8) >> 3));}
     inline void     Color565ToRGB(uint16_t color, uint8_t &r, uint8_t &g, uint8_t &b){r = (((color & 0xF800) >> 11) * 527 + 23) >> 6; g = (((color & 0x07E0) >> 5) * 259 + 33) >> 6; b = ((color & 0x001F) * 527 + 23) >> 6;}
+    inline uint8_t  Color565To332(uint16_t color) { return ((color & 0xE000) >> 8) | ((color & 0x0700) >> 6) | ((color & 0x0018) >> 3); }
+    inline uint16_t Color332To565(uint8_t color) { uint16_t r = color >> 5, g = (color >> 2) & 0x07, b = color & 0x03; return (((r << 2) | (r >> 1)) << 11) | (((g << 3) | g) << 5) | (b << 3) | (b << 1) | (b >> 1); }
+    void            Color565To332(const uint16_t *src, uint8_t *dst, uint32_t count);
     
     // Scrolling
     void        setScrollMode(enum RA8875scrollMode mode);
@@ -1429,6 +1629,8 @@ class XGLCD : public Print {
     
     // SPI & Low Level
     uint8_t     readStatus(void);
+    void        useInterrupt(boolean on);
+    void        usePipeline(boolean on);
     void        writeCommand(const uint8_t d);
     
     
@@ -1501,6 +1703,11 @@ private:
     bool        _portrait;
     uint8_t     _rotation;
     int16_t     _activeWindowXL,_activeWindowXR,_activeWindowYT,_activeWindowYB;
+    int16_t     _blitWindow[4];                                                 // active window saved by _setTempWindow
+    bool        _clipOn;
+    int16_t     _clipX1,_clipY1,_clipX2,_clipY2;                                // clip rectangle (inclusive)
+    int16_t     _clipStack[XG_CLIP_STACK][5];                                   // saved by pushClipRect: x1,y1,x2,y2,on
+    uint8_t     _clipDepth;
     // color vars
     uint16_t    _foreColor;
     uint16_t    _backColor;
@@ -1536,7 +1743,25 @@ private:
     uint8_t     _FWTSET_Reg;                                                    // Font Write Type Setting Register [0x2E]
     uint8_t     _SFRSET_Reg;                                                    // Serial Font ROM Setting [0x2F]
     uint8_t     _INTC1_Reg;                                                     // Interrupt Control Register1 [0xF0]
+    bool        _useInt;                                                        // Wait on the RA8875 INT pin instead of polling
+    // Pipelined hardware commands (usePipeline)
+    bool        _pipeline;
+    uint8_t     _pendReg;                                                       // Register to poll for the command in flight (0 = none)
+    uint8_t     _pendFlag;                                                      // Busy flag in _pendReg
+    uint8_t     _pendConfirm;
     volatile uint8_t _MWCR0_Reg;
+    // Write-through shadow of every RA8875 register
+    uint8_t     _regShadow[256];                                                // Last value written/read per register
+    uint32_t    _regShadowValid[8];                                             // One valid bit per register
+    // Queued register writes, sent as one burst by _flushRegisters()
+    uint16_t    _regBurst[32];                                                  // Command and data frames
+    uint8_t     _regBurstLen;
+    // Asynchronous (DMA) bitmap transfer
+    volatile bool _dmaBusy;                                                     // Transfer in progress, cleared by the interrupt
+    void        (*_dmaCallback)(void);                                          // Called from the interrupt when done
+    uint8_t     _dmaCmd;                                                        // Command byte, must live during the transfer
+    // Display list being recorded (beginRecording)
+    XGDisplayList * _dl;
     
     // Functions
     void        _setSysClock(uint8_t pll1,uint8_t pll2,uint8_t pixclk);
@@ -1558,14 +1783,23 @@ private:
     void        _setTextMode(bool m);
     void        _scanDirection(boolean invertH,boolean invertV);
     // helpers
+    void        _pixel_helper(int16_t x, int16_t y, uint16_t color);
+    void        _line_helper(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
     void        _circle_helper(int16_t x0, int16_t y0, int16_t r, uint16_t color, bool filled);
     void        _rect_helper(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color, bool filled);
     void        _roundRect_helper(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color, bool filled);
     float       _check_area(int16_t Ax, int16_t Ay, int16_t Bx, int16_t By, int16_t Cx, int16_t Cy);
     void        _triangle_helper(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color, bool filled);
     void        _ellipseCurve_helper(int16_t xCenter, int16_t yCenter, int16_t longAxis, int16_t shortAxis,uint8_t curvePart, uint16_t color, bool filled);
-    void        _drawArc_helper(uint16_t cx, uint16_t cy, uint16_t radius, uint16_t thickness, float startAngle, float endAngle, uint16_t color);
-    void        _line_addressing(int16_t x0, int16_t y0, int16_t x1, int16_t y1);
+    bool        _clipEngine(int16_t x1, int16_t y1, int16_t x2, int16_t y2, bool &window);
+    void        _drawArc_helper(int16_t cx, int16_t cy, uint16_t radius, uint16_t thickness, float startAngle, float endAngle, uint16_t color);
+    void        _arcSpan_helper(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
+    uint16_t    _ringMeterColor(int16_t i, int16_t angle, uint16_t colorScheme, uint16_t w);
+    friend class XGRingMeter;
+    void        _line_addressing(int16_t x0, int16_t y0, int16_t x1, int16_t y1, bool flush=true);
+    void        _batchShapes(const int16_t *items, uint16_t n, uint16_t color, const uint16_t *colors, bool rects);
+    void        _batchShape(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color, bool rect);
+    void        _queueForegroundColor(uint16_t color);
     void        _curve_addressing(int16_t x0, int16_t y0, int16_t x1, int16_t y1);
     float       _cosDeg_helper(float angle);
     float       _sinDeg_helper(float angle);
@@ -1576,10 +1810,59 @@ private:
     // low level functions
     void        _writeRegister(const uint8_t reg, uint8_t val);
     uint8_t     _readRegister(const uint8_t reg);
+    void        _queueRegister(const uint8_t reg, uint8_t val);
+    void        _flushRegisters(void);
+    void        _queueData(uint8_t val);
+    bool        _regIsVolatile(const uint8_t reg);
+    uint8_t     _regBusyBits(const uint8_t reg);
+    bool        _shadowUpdate(const uint8_t reg, uint8_t val);
+#if defined(XG_CPU_ESP32)
+    static void _dmaDoneISR(void *arg);
+#endif
+#if defined(XG_CPU_MKR) && !defined(XG_MKR_NO_DMA)
+    uint8_t     _dmacStage[2][XG_DMAC_STAGE];
+    void        _dmacInit(void);
+    bool        _dmacStart(const uint8_t *buf, uint32_t len, bool irq);
+    void        _dmacWait(void);
+    void        _dmacWrite(const uint8_t *buf, uint32_t len, bool swap16);
+    friend void XG_DMAC_Handler(void);
+#endif
+    void        _invalidateShadow(void);
+    void        _invalidateCursorShadow(void);
     void        _writeData(uint8_t data);
     void        _writeData16(uint16_t data);
+#ifdef XG_SPI_STAGE
+    uint8_t     _spiStage[XG_SPI_STAGE] __attribute__((aligned(4)));
+#endif
+#ifdef _spiwritebuf
+    void        _writeStaged(const uint16_t *p, uint16_t color, uint32_t count);
+#endif
+    void        _writePixels8(const uint8_t *p, uint32_t count);
+    void        _writeBytes(const uint8_t *p, uint32_t count);
+    void        _writePixels16(const uint16_t *p, uint32_t count);
+    bool        _blitBegin(int16_t &x, int16_t &y, int16_t &w, int16_t &h, uint32_t &offset, uint16_t stride);
+    void        _blitEnd(void);
+    void        _bteMcuBegin(int16_t x, int16_t y, int16_t w, int16_t h, uint8_t becr1);
+    bool        _clipBlit(int16_t &x, int16_t &y, int16_t &w, int16_t &h, uint32_t &offset, uint16_t stride);
+    void        _clipBox(int16_t &x1, int16_t &y1, int16_t &x2, int16_t &y2);
+    uint8_t     _clipTest(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+    bool        _clipRect(int16_t &x1, int16_t &y1, int16_t &x2, int16_t &y2);
+    bool        _clipRun(int16_t &x, int16_t y, uint32_t &count, uint32_t &skip);
+    bool        _clipLine(int16_t &x0, int16_t &y0, int16_t &x1, int16_t &y1);
+    uint8_t     _clipPolygon(int16_t *x, int16_t *y, uint8_t n);
+    void        _recordClip(void);
+    void        _setTempWindow(int16_t x, int16_t y, int16_t w, int16_t h);
+    void        _setReadCursor(int16_t x, int16_t y);
+    void        _readPixels(uint16_t *dst, uint32_t count, uint32_t width, uint32_t stride, bool first=true);
+    void        _bitmapTransform(int16_t x, int16_t y, uint16_t width, uint16_t height, const uint8_t *image, float angle, float scale, float rx, float ry, bool smooth);
+    uint16_t    _bitmapSample(const uint8_t *image, uint16_t width, uint16_t height, int32_t u, int32_t v, bool smooth);
     uint8_t     _readData(bool stat=false);
-    boolean     _waitPoll(uint8_t r, uint8_t f);
+    boolean     _waitPoll(uint8_t r, uint8_t f, uint8_t confirm=1);
+    bool        _waitInt(uint8_t src);
+    void        _waitEngine(uint8_t r, uint8_t f, uint8_t confirm=1);
+    void        _syncEngine(void);
+    bool        _regConflicts(const uint8_t reg);
+    uint8_t     _readDataFast(bool stat);
     void        _waitBusy(uint8_t res=0x80);                                    //0x80, 0x40(BTE busy), 0x01(DMA busy)
      inline __attribute__((always_inline)) void _checkLimits_helper(int16_t &x,int16_t &y);
     inline __attribute__((always_inline)) void _center_helper(int16_t &x, int16_t &y);
@@ -0,0 +1,126 @@
+/*
+ Incremental ring meter for the XGLCD library for www.x-graph.be
+ Copyright (c) 2019 DELCOMp bvba / UVee bvba
+ 2sd (a t) delcomp (d o t) com
+
+ License:GNU General Public License v3.0
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "XGRingMeter.h"
+#include <stdlib.h>
+
+#define XG_RING_SEG                 5                                           // segment width in degrees (as ringMeter)
+
+XGRingMeter::XGRingMeter(void)
+{
+    _tft = NULL;
+    _seg = NULL;
+    _n = 0;
+    _active = -1;
+}
+
+XGRingMeter::~XGRingMeter(void)
+{
+    free(_seg);
+}
+
+/******************************************************************************/
+/*!
+ Calculate the segments, nothing is drawn
+ Parameters: see XGLCD::ringMeter
+ Returns: false if the segments could not be allocated
+ */
+/******************************************************************************/
+bool XGRingMeter::begin(XGLCD &tft, int minV, int maxV, int16_t x, int16_t y, uint16_t r, uint16_t colorScheme, uint16_t backSegColor, int16_t angle, uint8_t inc)
+{
+    int16_t i, c, s;
+    uint16_t w;
+    uint8_t k;
+
+    if (inc < 5) inc = 5;
+    if (inc > 20) inc = 20;
+    if (r < 50) r = 50;
+    if (angle < 90) angle = 90;
+    if (angle > 180) angle = 180;
+    _tft = &tft;
+    _minV = minV;
+    _maxV = maxV;
+    _angle = angle;
+    _inc = inc;
+    _backColor = backSegColor;
+    _active = -1;
+    _n = (2 * angle + inc - 1) / inc;
+    free(_seg);
+    _seg = (Segment *)malloc(_n * sizeof(Segment));
+    if (_seg == NULL) {
+        _n = 0;
+        return false;
+    }
+
+    x += r;
+    y += r;                                                                     // Center of the ring
+    w = r / 4;                                                                  // Width of the ring
+    for (k = 0, i = -angle; k < _n; k++, i += inc) {
+        Segment &g = _seg[k];
+        c = xgCosDeg(i - 90);                                                   // Segment start
+        s = xgSinDeg(i - 90);
+        g.x[0] = xgMulQ15(r - w, c) + x;
+        g.y[0] = xgMulQ15(r - w, s) + y;
+        g.x[1] = xgMulQ15(r, c) + x;
+        g.y[1] = xgMulQ15(r, s) + y;
+        c = xgCosDeg(i + XG_RING_SEG - 90);                                     // Segment end
+        s = xgSinDeg(i + XG_RING_SEG - 90);
+        g.x[2] = xgMulQ15(r - w, c) + x;
+        g.y[2] = xgMulQ15(r - w, s) + y;
+        g.x[3] = xgMulQ15(r, c) + x;
+        g.y[3] = xgMulQ15(r, s) + y;
+        g.color = tft._ringMeterColor(i, angle, colorScheme, w);
+    }
+    return true;
+}
+
+/******************************************************************************/
+/*!
+ Show a new value, only the segments that change state are drawn
+ (all segments after begin() or invalidate())
+ */
+/******************************************************************************/
+void XGRingMeter::update(int val)
+{
+    int32_t cur, n;
+    uint8_t k, from, to;
+
+    if (_n == 0) return;
+    cur = map(val, _minV, _maxV, -_angle, _angle) + _angle;                     // Segment k is active when k * inc < cur
+    n = (cur <= 0) ? 0 : (cur + _inc - 1) / _inc;
+    if (n > _n) n = _n;
+    if (_active < 0) {
+        from = 0;
+        to = _n;
+    } else {
+        from = (n < _active) ? n : _active;
+        to = (n < _active) ? _active : n;
+    }
+    for (k = from; k < to; k++) _fill(k, k < n);
+    _active = n;
+}
+
+void XGRingMeter::_fill(uint8_t k, bool active)
+{
+    const Segment &g = _seg[k];
+
+    _tft->fillQuad(g.x[0], g.y[0], g.x[1], g.y[1], g.x[2], g.y[2], g.x[3], g.y[3], active ? g.color : _backColor, false);
+}
@@ -0,0 +1,75 @@
+/*
+ Incremental ring meter for the XGLCD library for www.x-graph.be
+ Same look as XGLCD::ringMeter, but the segment geometry is calculated once and
+ an update only redraws the segments that change between active and back color
+ Copyright (c) 2019 DELCOMp bvba / UVee bvba
+ 2sd (a t) delcomp (d o t) com
+
+ License:GNU General Public License v3.0
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ USE:
+    #include <XGRingMeter.h>
+
+    XGRingMeter rpm;
+
+    rpm.begin(tft, 0, 8000, 20, 20, 100);       // same parameters as ringMeter (without val and units)
+    rpm.update(2500);                           // first call draws all segments
+    rpm.update(2600);                           // only the segments between 2500 and 2600
+
+ NOTES:
+ - the center of the ring (units text) is not drawn
+ - call invalidate() when the meter was overwritten (clearScreen, layer change, ...),
+   the next update() redraws all segments
+ - the geometry is allocated on the heap: 18 bytes per segment, (2 * angle) / inc segments
+ - with inc 5 the segments touch, the shared edge gets the color of the segment drawn last
+*/
+
+#ifndef _XGRINGMETER_H_
+#define _XGRINGMETER_H_
+
+#include "XGLCD.h"
+
+class XGRingMeter {
+  public:
+    XGRingMeter(void);
+    ~XGRingMeter(void);
+
+    bool            begin(XGLCD &tft, int minV, int maxV, int16_t x, int16_t y, uint16_t r, uint16_t colorScheme=4, uint16_t backSegColor=COLOR_BLACK, int16_t angle=150, uint8_t inc=10);
+    void            update(int val);
+    void            invalidate(void) { _active = -1; }
+    uint8_t         segments(void) const { return _n; }
+
+  private:
+    struct Segment {
+        int16_t     x[4];                                                       // inner/outer start, inner/outer end
+        int16_t     y[4];
+        uint16_t    color;                                                      // active color
+    };
+
+    XGLCD *         _tft;
+    Segment *       _seg;
+    uint8_t         _n;
+    int16_t         _active;                                                    // active segments on the screen, -1 = not drawn
+    int             _minV;
+    int             _maxV;
+    int16_t         _angle;
+    uint8_t         _inc;
+    uint16_t        _backColor;
+
+    void            _fill(uint8_t k, bool active);
+};
+
+#endif
@@ -0,0 +1,141 @@
+/*
+ SPI traffic profiler for the XGLCD library for www.x-graph.be
+ Copyright (c) 2019 DELCOMp bvba / UVee bvba
+ 2sd (a t) delcomp (d o t) com
+
+ License:GNU General Public License v3.0
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "XGLCD.h"
+
+#if defined(XG_SPI_PROFILE)
+
+#include <string.h>
+
+XGSpiProfile xgSpiProfile;
+
+XGSpiProfile::XGSpiProfile(void)
+{
+    reset();
+}
+
+/******************************************************************************/
+/*!
+ Clear all counters
+ */
+/******************************************************************************/
+void XGSpiProfile::reset(void)
+{
+    memset(_e, 0, sizeof(_e));
+    _e[0].name = "(other)";
+    _n = 1;
+    _depth = 0;
+    cur = &_e[0];
+}
+
+/******************************************************************************/
+/*!
+ Start of a public XGLCD function, only the outermost call is counted
+ Parameters:
+ name: function name (__func__), overloaded functions share one entry
+ */
+/******************************************************************************/
+void XGSpiProfile::enter(const char *name)
+{
+    uint8_t i;
+
+    if (_depth++ != 0) return;
+    for (i = 1; i < _n; i++) {
+        if ((_e[i].name == name) || (strcmp(_e[i].name, name) == 0)) break;
+    }
+    if (i == _n) {
+        if (_n < XG_PROFILE_ENTRIES) {
+            _e[_n++].name = name;
+        } else {
+            i = 0;                                                              // Table full
+        }
+    }
+    cur = &_e[i];
+    cur->calls++;
+    _start = micros();
+}
+
+void XGSpiProfile::leave(void)
+{
+    if (_depth == 0) return;                                                    // reset() inside a call
+    if (--_depth != 0) return;
+    cur->us += micros() - _start;
+    cur = &_e[0];
+}
+
+/******************************************************************************/
+/*!
+ Sum of all entries
+ */
+/******************************************************************************/
+XGSpiCounters XGSpiProfile::total(void) const
+{
+    XGSpiCounters t;
+
+    memset(&t, 0, sizeof(t));
+    t.name = "TOTAL";
+    for (uint8_t i = 0; i < _n; i++) {
+        t.calls += _e[i].calls;
+        t.txBytes += _e[i].txBytes;
+        t.rxBytes += _e[i].rxBytes;
+        t.csCycles += _e[i].csCycles;
+        t.speedSwitches += _e[i].speedSwitches;
+        t.busyPolls += _e[i].busyPolls;
+        t.regWrites += _e[i].regWrites;
+        t.commands += _e[i].commands;
+        t.us += _e[i].us;
+    }
+    return t;
+}
+
+/******************************************************************************/
+/*!
+ Print one line per function (tab separated) followed by the totals
+ A function with many CS cycles and few bytes per cycle is command bound,
+ a function with a high byte count per call is pixel bound
+ Parameters:
+ out: Serial or any other Print object
+ */
+/******************************************************************************/
+static void _printCounters(Print &out, const XGSpiCounters &c)
+{
+    out.print(c.name);
+    out.print('\t'); out.print(c.calls);
+    out.print('\t'); out.print(c.txBytes);
+    out.print('\t'); out.print(c.rxBytes);
+    out.print('\t'); out.print(c.csCycles);
+    out.print('\t'); out.print(c.speedSwitches);
+    out.print('\t'); out.print(c.busyPolls);
+    out.print('\t'); out.print(c.regWrites);
+    out.print('\t'); out.print(c.commands);
+    out.print('\t'); out.println(c.us);
+}
+
+void XGSpiProfile::print(Print &out) const
+{
+    out.println("function\tcalls\ttx\trx\tcs\tspeed\tpolls\tregs\tcmds\tus");
+    for (uint8_t i = 0; i < _n; i++) {
+        if (_e[i].calls || _e[i].txBytes || _e[i].rxBytes) _printCounters(out, _e[i]);
+    }
+    _printCounters(out, total());
+}
+
+#endif
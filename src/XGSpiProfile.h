@@ -0,0 +1,91 @@
+/*
+ SPI traffic profiler for the XGLCD library for www.x-graph.be
+ Counts the SPI traffic of the XGLCD library and attributes it to the public
+ XGLCD function that caused it
+ Copyright (c) 2019 DELCOMp bvba / UVee bvba
+ 2sd (a t) delcomp (d o t) com
+
+ License:GNU General Public License v3.0
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ USE:
+    Enable XG_SPI_PROFILE in the user defines of XGLCD.h (or on the compiler command line)
+
+    xgSpiProfile.reset();
+    drawMyScreen();
+    xgSpiProfile.print(Serial);
+
+ NOTES:
+ - without XG_SPI_PROFILE the hooks in the SPI macro's are empty and this file is not used
+ - nested calls (fillRect calling drawLine, ...) are counted in the outermost public call,
+   traffic outside any public call (or when the table is full) is counted in "(other)"
+ - us is the time spent inside the call, including waits for the draw engines and the profiler overhead
+ - an asynchronous transfer (drawBitmapAsync) is counted when it is started, its time ends up in the
+   call that waits for it
+ - ESP32: the CS line is driven by the SPI peripheral, every transaction counts as one CS cycle
+*/
+
+#ifndef _XGSPIPROFILE_H_
+#define _XGSPIPROFILE_H_
+
+#include <stdint.h>
+
+#define XG_PROFILE_ENTRIES              48                                      // different public functions that can be tracked
+
+struct XGSpiCounters {
+    const char *    name;                                                       // public XGLCD function
+    uint32_t        calls;
+    uint32_t        txBytes;                                                    // bytes written (command, data and pixel bytes)
+    uint32_t        rxBytes;                                                    // bytes read (status, register and pixel reads)
+    uint32_t        csCycles;                                                   // CS assertions (SPI transactions)
+    uint32_t        speedSwitches;                                              // _spisetSpeed calls
+    uint32_t        busyPolls;                                                  // status/register/INT pin polls while waiting for the RA8875
+    uint32_t        regWrites;                                                  // register writes (direct and queued)
+    uint32_t        commands;                                                   // writeCommand calls (register select)
+    uint32_t        us;
+};
+
+class XGSpiProfile {
+  public:
+    XGSpiProfile(void);
+
+    void                    reset(void);
+    uint8_t                 entries(void) const { return _n; }                  // entry 0 is "(other)"
+    const XGSpiCounters &   entry(uint8_t i) const { return _e[i]; }
+    XGSpiCounters           total(void) const;
+    void                    print(Print &out) const;
+
+    // used by the hooks in XGLCD.h
+    XGSpiCounters *         cur;                                                // counters of the running public call
+    void                    enter(const char *name);
+    void                    leave(void);
+
+  private:
+    XGSpiCounters           _e[XG_PROFILE_ENTRIES];
+    uint8_t                 _n;
+    uint8_t                 _depth;
+    uint32_t                _start;
+};
+
+extern XGSpiProfile xgSpiProfile;
+
+// Placed at the start of every public XGLCD function by _XGP_SCOPE
+class XGSpiScope {
+  public:
+    XGSpiScope(const char *name) { xgSpiProfile.enter(name); }
+    ~XGSpiScope(void) { xgSpiProfile.leave(); }
+};
+
+#endif
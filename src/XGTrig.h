@@ -0,0 +1,128 @@
+/*
+ Fixed point trigonometry for the XGLCD library for www.x-graph.be
+ Sine and cosine from a Q15 quarter wave table that is generated by the
+ compiler, no floating point (soft-float on the SAMD21 and nRF51) at run time
+ Copyright (c) 2019 DELCOMp bvba / UVee bvba
+ 2sd (a t) delcomp (d o t) com
+
+ License:GNU General Public License v3.0
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ USE:
+    int16_t s = xgSinDeg(30);                   // 16383 (0.5 in Q15)
+    int16_t c = xgCosDeci(455);                 // cos(45.5 degrees), linear interpolation
+    x = cx + xgMulQ15(r, xgCosDeg(angle));      // r * cos(angle), rounded
+
+ NOTES:
+ - angles can be negative or larger than 360 degrees
+ - 1.0 is 32767, the error of the tenths of a degree functions is below 2 LSB
+ - screen coordinates: y points down, so positive angles turn clockwise
+*/
+
+#ifndef _XGTRIG_H_
+#define _XGTRIG_H_
+
+#include <stdint.h>
+
+#define XG_Q15_ONE                  32767
+
+// Compile time sine (Taylor series, |x| <= PI/2)
+constexpr double _xgSinSeries(double x2, double term, int k, int n)
+{
+    return (n == 0) ? term : term + _xgSinSeries(x2, -term * x2 / ((k + 1) * (k + 2)), k + 2, n - 1);
+}
+
+#define _XG_SINQ15(d)               ((int16_t)(_xgSinSeries(((d) * 3.14159265358979323846 / 180) * ((d) * 3.14159265358979323846 / 180), (d) * 3.14159265358979323846 / 180, 1, 12) * XG_Q15_ONE + 0.5))
+#define _XG_SINQ15X10(d)            _XG_SINQ15(d), _XG_SINQ15(d+1), _XG_SINQ15(d+2), _XG_SINQ15(d+3), _XG_SINQ15(d+4), \
+                                    _XG_SINQ15(d+5), _XG_SINQ15(d+6), _XG_SINQ15(d+7), _XG_SINQ15(d+8), _XG_SINQ15(d+9)
+
+// sin(0..90 degrees) in Q15
+static constexpr int16_t _xgSinQ15[91] = {
+    _XG_SINQ15X10(0), _XG_SINQ15X10(10), _XG_SINQ15X10(20), _XG_SINQ15X10(30), _XG_SINQ15X10(40),
+    _XG_SINQ15X10(50), _XG_SINQ15X10(60), _XG_SINQ15X10(70), _XG_SINQ15X10(80), _XG_SINQ15(90)
+};
+
+/******************************************************************************/
+/*!
+ Sine and cosine of a whole number of degrees
+ Returns: Q15 (-32767 .. 32767)
+ */
+/******************************************************************************/
+static inline int16_t xgSinDeg(int32_t deg)
+{
+    deg %= 360;
+    if (deg < 0) deg += 360;
+    if (deg <= 90) return _xgSinQ15[deg];
+    if (deg <= 180) return _xgSinQ15[180 - deg];
+    if (deg <= 270) return -_xgSinQ15[deg - 180];
+    return -_xgSinQ15[360 - deg];
+}
+
+static inline int16_t xgCosDeg(int32_t deg)
+{
+    return xgSinDeg(deg + 90);
+}
+
+/******************************************************************************/
+/*!
+ Sine and cosine in tenths of a degree (interpolated between the whole degrees)
+ Returns: Q15 (-32767 .. 32767)
+ */
+/******************************************************************************/
+static inline int16_t _xgSinQuarter(int32_t deci)                               // 0 .. 900
+{
+    int32_t i = deci / 10, f = deci % 10;
+
+    if (f == 0) return _xgSinQ15[i];
+    return _xgSinQ15[i] + (((_xgSinQ15[i + 1] - _xgSinQ15[i]) * f + 5) / 10);
+}
+
+static inline int16_t xgSinDeci(int32_t deci)
+{
+    deci %= 3600;
+    if (deci < 0) deci += 3600;
+    if (deci <= 900) return _xgSinQuarter(deci);
+    if (deci <= 1800) return _xgSinQuarter(1800 - deci);
+    if (deci <= 2700) return -_xgSinQuarter(deci - 1800);
+    return -_xgSinQuarter(3600 - deci);
+}
+
+static inline int16_t xgCosDeci(int32_t deci)
+{
+    return xgSinDeci(deci + 900);
+}
+
+/******************************************************************************/
+/*!
+ Degrees to tenths of a degree, rounded half away from zero
+ (single precision, no double round() on the FPU-less targets)
+ */
+/******************************************************************************/
+static inline int32_t xgDeci(float deg)
+{
+    return (int32_t)(deg * 10 + (deg >= 0 ? 0.5f : -0.5f));
+}
+
+/******************************************************************************/
+/*!
+ v * q with q in Q15, rounded to the nearest integer
+ */
+/******************************************************************************/
+static inline int32_t xgMulQ15(int32_t v, int16_t q)
+{
+    return (v * q + 16384) >> 15;
+}
+
+#endif
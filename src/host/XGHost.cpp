@@ -0,0 +1,838 @@
+/*
+ Host (PC) backend for the XGLCD library for www.x-graph.be
+ RA8875 model, see XGHost.h
+ Copyright (c) 2019 DELCOMp bvba / UVee bvba
+ 2sd (a t) delcomp (d o t) com
+
+ License:GNU General Public License v3.0
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "../XGLCD.h"
+
+#if defined(XG_CPU_HOST)                                                        // Not compiled for the CPU modules
+
+XGHostSerial Serial;
+XGHost xgHost;
+
+XGHost::XGHost(void)
+{
+    memset(&stats, 0, sizeof(stats));
+    memset(_mem, 0, sizeof(_mem));
+    memset(_pins, HIGH, sizeof(_pins));
+    _isr = NULL;
+    _speed = SPI_SPEED_SLOW;
+    _cs = false;
+    _frameIdx = 0;
+    _frameType = 0;
+    _curReg = 0;
+    _reset();
+}
+
+void XGHost::begin(void)
+{
+    _cs = false;
+}
+
+/******************************************************************************/
+/*!
+ Chip reset (RESET pin or PWRR software reset), video memory is kept
+ [private]
+ */
+/******************************************************************************/
+void XGHost::_reset(void)
+{
+    memset(_reg, 0, sizeof(_reg));
+    _memHalf = false;
+    _memReadIdx = 0;
+    _bteMcu = false;
+}
+
+/*
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
++                                SPI & PINS                                    +
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+Every CS low period is one RA8875 SPI cycle: the first byte selects the cycle
+type (0x80 command write, 0x00 data write, 0x40 data read, 0xC0 status read),
+all following bytes are the register number or data.
+ */
+
+void XGHost::csLow(void)
+{
+    if (_cs) return;
+    _cs = true;
+    _frameIdx = 0;
+    stats.csFalling++;
+}
+
+void XGHost::csHigh(void)
+{
+    if (!_cs) return;
+    _cs = false;
+    stats.csRising++;
+}
+
+uint8_t XGHost::transfer(uint8_t b)
+{
+    uint8_t r = 0;
+
+    stats.bytes++;
+    stats.ns += 8000000000ULL / (_speed ? _speed : 1);
+    if (!_cs) return 0xFF;
+
+    if (_frameIdx++ == 0) {
+        _frameType = b & 0xC0;
+        if (_frameType == RA8875_CMDREAD) stats.statusReads++;
+        return 0;
+    }
+    switch (_frameType) {
+        case (RA8875_CMDWRITE >> 8):
+            _curReg = b;
+            if (b == RA8875_MRWC) {
+                _memHalf = false;
+                _memReadIdx = 0;
+            }
+            break;
+        case RA8875_DATAWRITE:
+            if (_curReg == RA8875_MRWC) {
+                _memWrite(b);
+            } else {
+                stats.regWrites++;
+                _writeReg(_curReg, b);
+            }
+            break;
+        case RA8875_DATAREAD:
+            if (_curReg == RA8875_MRWC) {
+                r = _memRead();
+            } else {
+                stats.regReads++;
+                r = _readReg(_curReg);
+            }
+            break;
+        case RA8875_CMDREAD:
+            r = _bteMcu ? 0x40 : 0x00;                                          // Only the BTE can be busy (waiting for MCU data)
+            break;
+    }
+    return r;
+}
+
+void XGHost::pinWrite(uint8_t pin, uint8_t v)
+{
+    if (pin == XG_PIN_LCD_CS) {
+        v ? csHigh() : csLow();
+    } else if (pin == XG_PIN_LCD_RESET && v == LOW) {
+        _reset();
+    }
+    if (pin < sizeof(_pins)) _pins[pin] = v;
+}
+
+uint8_t XGHost::pinRead(uint8_t pin)
+{
+    if (pin == XG_PIN_TP_IRQ) return (_reg[RA8875_INTC1] & _reg[RA8875_INTC2] & 0x1F) ? LOW : HIGH;   // INT is active low
+    return (pin < sizeof(_pins)) ? _pins[pin] : LOW;
+}
+
+void XGHost::attachIsr(uint8_t pin, void (*isr)(void))
+{
+    if (pin == XG_PIN_TP_IRQ) _isr = isr;
+}
+
+/******************************************************************************/
+/*!
+ Call the interrupt routine when INT went low
+ Parameters:
+ before: INT pin level before the INTC1/INTC2 change
+ [private]
+ */
+/******************************************************************************/
+void XGHost::_intUpdate(uint8_t before)
+{
+    if (_isr && before == HIGH && pinRead(XG_PIN_TP_IRQ) == LOW) _isr();
+}
+
+/*
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
++                                REGISTERS                                     +
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ */
+
+void XGHost::_writeReg(uint8_t r, uint8_t v)
+{
+    switch (r) {
+        case RA8875_PWRR:
+            if (v & RA8875_PWRR_SOFTRESET) _reset();
+            _reg[r] = v;
+            break;
+        case RA8875_RCURH0:
+        case RA8875_RCURH0 + 1:
+        case RA8875_RCURV0:
+        case RA8875_RCURV0 + 1:
+            _reg[r] = v;
+            _memReadIdx = 0;
+            break;
+        case RA8875_BECR0:
+            _reg[r] = v;
+            if (v & 0x80) _bteStart();
+            break;
+        case RA8875_MCLR:
+            _reg[r] = v;
+            if (v & RA8875_MCLR_START) _memoryClear();
+            break;
+        case RA8875_DCR:
+            _reg[r] = v;
+            if (v & 0xC0) _drawEngine(v);
+            break;
+        case RA8875_ELLIPSE:
+            _reg[r] = v;
+            if (v & 0x80) _ellipseEngine(v);
+            break;
+        case RA8875_INTC1: {
+            uint8_t before = pinRead(XG_PIN_TP_IRQ);
+            _reg[r] = v;
+            _intUpdate(before);
+            break;
+        }
+        case RA8875_INTC2:
+            _reg[r] &= ~v;                                                      // Write 1 to clear
+            break;
+        default:
+            _reg[r] = v;
+            break;
+    }
+}
+
+uint8_t XGHost::_readReg(uint8_t r)
+{
+    switch (r) {
+        case RA8875_GPI:    return 0x00;                                        // 5.0" 800x480 LCD
+        default:            return _reg[r];
+    }
+}
+
+/*
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
++                                VIDEO MEMORY                                  +
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ */
+
+uint16_t XGHost::width(void) const
+{
+    uint16_t w = ((_reg[RA8875_HDWR] & 0x7F) + 1) * 8;
+    return (_reg[RA8875_HDWR] == 0 || w > XG_HOST_MAX_WIDTH) ? XG_HOST_MAX_WIDTH : w;
+}
+
+uint16_t XGHost::height(void) const
+{
+    uint16_t h = (_get16(RA8875_VDHR0) & 0x1FF) + 1;
+    return (_get16(RA8875_VDHR0) == 0 || h > XG_HOST_MAX_HEIGHT) ? XG_HOST_MAX_HEIGHT : h;
+}
+
+uint8_t XGHost::_layer(void) const
+{
+    return (_reg[RA8875_DPCR] & RA8875_DPCR_TWO_LAYERS) ? (_reg[RA8875_MWCR1] & 0x01) : 0;
+}
+
+bool XGHost::_inWindow(int16_t x, int16_t y) const
+{
+    if (x < 0 || y < 0 || x >= width() || y >= height()) return false;
+    return x >= (int16_t)_get16(RA8875_HSAW0) && x <= (int16_t)_get16(RA8875_HEAW0) &&
+           y >= (int16_t)_get16(RA8875_VSAW0) && y <= (int16_t)_get16(RA8875_VEAW0);
+}
+
+void XGHost::_memWrite(uint8_t b)
+{
+    uint16_t c;
+
+    if (_reg[RA8875_MWCR0] & RA8875_MWCR0_TXTMODE) {
+        _fontWrite(b);
+        return;
+    }
+    if (_bteMcu && (_reg[RA8875_BECR1] & 0x0E) == 0x08) {                       // Color expansion data has the width of the MCU bus (8 bit)
+        _bteMcuPixel(b);
+        return;
+    }
+    if (is16bpp()) {                                                            // high byte first
+        if (!_memHalf) {
+            _memHi = b;
+            _memHalf = true;
+            return;
+        }
+        _memHalf = false;
+        c = (_memHi << 8) | b;
+    } else {
+        c = b;
+    }
+    if (_bteMcu) {
+        _bteMcuPixel(c);
+    } else {
+        _memWritePixel(c);
+    }
+}
+
+void XGHost::_memWritePixel(uint16_t c)
+{
+    int16_t x = _get16(RA8875_CURH0) & 0x3FF;
+    int16_t y = _get16(RA8875_CURV0) & 0x1FF;
+    int16_t xs = _get16(RA8875_HSAW0), xe = _get16(RA8875_HEAW0);
+    int16_t ys = _get16(RA8875_VSAW0), ye = _get16(RA8875_VEAW0);
+
+    stats.memWrites++;
+    if ((_reg[RA8875_MWCR1] & 0x0C) == 0 && x < width() && y < height()) {      // Only layer memory is modelled (not CGRAM, pattern, cursor)
+        _mem[_layer()][(y * XG_HOST_MAX_WIDTH) + x] = c;
+    }
+    if (_reg[RA8875_MWCR0] & RA8875_MWCR0_MEMWR_NO_INC) return;
+    switch (_reg[RA8875_MWCR0] & RA8875_MWCR0_MEMWRDIR_MASK) {                  // Advance within the active window
+        case RA8875_MWCR0_MEMWRDIR_LT:
+            if (++x > xe) { x = xs; if (++y > ye) y = ys; }
+            break;
+        case RA8875_MWCR0_MEMWRDIR_RT:
+            if (--x < xs) { x = xe; if (++y > ye) y = ys; }
+            break;
+        case RA8875_MWCR0_MEMWRDIR_TL:
+            if (++y > ye) { y = ys; if (++x > xe) x = xs; }
+            break;
+        case RA8875_MWCR0_MEMWRDIR_DL:
+            if (--y < ys) { y = ye; if (++x > xe) x = xs; }
+            break;
+    }
+    _set16(RA8875_CURH0, x);
+    _set16(RA8875_CURV0, y);
+}
+
+uint8_t XGHost::_memRead(void)
+{
+    uint8_t bpp = is16bpp() ? 2 : 1;
+    uint32_t k;
+    int16_t x, y;
+
+    if (_memReadIdx < bpp) {                                                    // The first pixel read is a dummy
+        _memReadIdx++;
+        return 0;
+    }
+    k = _memReadIdx++ - bpp;
+    if ((k % bpp) == 0) {
+        x = _get16(RA8875_RCURH0) & 0x3FF;
+        y = _get16(RA8875_RCURV0) & 0x1FF;
+        _memReadPix = (x < width() && y < height()) ? _mem[_layer()][(y * XG_HOST_MAX_WIDTH) + x] : 0;
+        stats.memReads++;
+        if (!(_reg[RA8875_MWCR0] & RA8875_MWCR0_MEMRD_NO_INC)) {
+            int16_t xs = _get16(RA8875_HSAW0), xe = _get16(RA8875_HEAW0);
+            int16_t ys = _get16(RA8875_VSAW0), ye = _get16(RA8875_VEAW0);
+            switch (_reg[RA8875_MRCD] & 0x03) {                                 // Advance within the active window
+                case 0: if (++x > xe) { x = xs; if (++y > ye) y = ys; } break;
+                case 1: if (--x < xs) { x = xe; if (++y > ye) y = ys; } break;
+                case 2: if (++y > ye) { y = ys; if (++x > xe) x = xs; } break;
+                case 3: if (--y < ys) { y = ye; if (++x > xe) x = xs; } break;
+            }
+            _set16(RA8875_RCURH0, x);
+            _set16(RA8875_RCURV0, y);
+        }
+    }
+    if (bpp == 1) return _memReadPix;
+    return (k % 2) ? (_memReadPix & 0xFF) : (_memReadPix >> 8);
+}
+
+/******************************************************************************/
+/*!
+ Text mode data write: glyphs are not modelled, only the font cursor moves
+ and the font write interrupt flag is set
+ [private]
+ */
+/******************************************************************************/
+void XGHost::_fontWrite(uint8_t c)
+{
+    uint16_t x = _get16(RA8875_F_CURXL);
+
+    (void)c;
+    stats.memWrites++;
+    x += 8 * (((_reg[RA8875_FNCR1] >> 2) & 0x03) + 1);
+    uint8_t before = pinRead(XG_PIN_TP_IRQ);
+    _set16(RA8875_F_CURXL, x);
+    _reg[RA8875_INTC2] |= RA8875_INTCx_FONT;
+    _intUpdate(before);
+}
+
+/*
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
++                                DRAW ENGINES                                  +
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ */
+
+uint16_t XGHost::_colorReg(uint8_t r) const
+{
+    if (is16bpp()) return ((_reg[r] & 0x1F) << 11) | ((_reg[r + 1] & 0x3F) << 5) | (_reg[r + 2] & 0x1F);
+    return ((_reg[r] & 0x07) << 5) | ((_reg[r + 1] & 0x07) << 2) | (_reg[r + 2] & 0x03);
+}
+
+uint16_t XGHost::_fg(void) const { return _colorReg(RA8875_FGCR0); }
+uint16_t XGHost::_bg(void) const { return _colorReg(RA8875_BGCR0); }
+
+void XGHost::_plot(int16_t x, int16_t y, uint16_t c)
+{
+    if (_inWindow(x, y)) _mem[_layer()][(y * XG_HOST_MAX_WIDTH) + x] = c;
+}
+
+void XGHost::_hline(int16_t x1, int16_t x2, int16_t y, uint16_t c)
+{
+    int16_t x;
+    if (x1 > x2) { x = x1; x1 = x2; x2 = x; }
+    for (x = x1; x <= x2; x++) _plot(x, y, c);
+}
+
+void XGHost::_line(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t c)
+{
+    int16_t dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    int16_t dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+    int32_t err = dx + dy, e2;
+
+    for (;;) {
+        _plot(x0, y0, c);
+        if (x0 == x1 && y0 == y1) break;
+        e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x0 += sx; }
+        if (e2 <= dx) { err += dx; y0 += sy; }
+    }
+}
+
+/******************************************************************************/
+/*!
+ Ellipse, circle or curve (one or more quadrants)
+ quads: bit n = curve part n (0 lower-left, 1 upper-left, 2 upper-right, 3 lower-right)
+ [private]
+ */
+/******************************************************************************/
+void XGHost::_ellipse(int16_t xc, int16_t yc, int16_t a, int16_t b, uint8_t quads, bool fill, uint16_t c)
+{
+    int16_t dx, dy, s;
+
+    if (a < 1) a = 1;
+    if (b < 1) b = 1;
+    for (dy = 0; dy <= b; dy++) {                                               // rows
+        dx = (int16_t)floor((a * sqrt(1.0 - ((double)dy * dy) / ((double)b * b))) + 0.5);
+        for (s = -1; s <= 1; s += 2) {
+            if (s > 0 && dy == 0) break;
+            if (fill) {
+                if (quads & ((s > 0) ? 0x01 : 0x02)) _hline(xc - dx, xc, yc + (s * dy), c);
+                if (quads & ((s > 0) ? 0x08 : 0x04)) _hline(xc, xc + dx, yc + (s * dy), c);
+            } else {
+                if (quads & ((s > 0) ? 0x01 : 0x02)) _plot(xc - dx, yc + (s * dy), c);
+                if (quads & ((s > 0) ? 0x08 : 0x04)) _plot(xc + dx, yc + (s * dy), c);
+            }
+        }
+    }
+    if (fill) return;
+    for (dx = 0; dx <= a; dx++) {                                               // columns, closes the gaps of the steep parts
+        dy = (int16_t)floor((b * sqrt(1.0 - ((double)dx * dx) / ((double)a * a))) + 0.5);
+        if (quads & 0x01) _plot(xc - dx, yc + dy, c);
+        if (quads & 0x02) _plot(xc - dx, yc - dy, c);
+        if (quads & 0x04) _plot(xc + dx, yc - dy, c);
+        if (quads & 0x08) _plot(xc + dx, yc + dy, c);
+    }
+}
+
+void XGHost::_triangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, bool fill, uint16_t c)
+{
+    int16_t px[3] = {x0, x1, x2}, py[3] = {y0, y1, y2};
+    int16_t y, ymin, ymax, xl, xr, x;
+    uint8_t i, j;
+
+    if (fill) {
+        ymin = min(y0, min(y1, y2));
+        ymax = max(y0, max(y1, y2));
+        for (y = ymin; y <= ymax; y++) {
+            xl = 32767; xr = -32768;
+            for (i = 0; i < 3; i++) {
+                j = (i + 1) % 3;
+                if ((y < py[i] && y < py[j]) || (y > py[i] && y > py[j])) continue;
+                if (py[i] == py[j]) {
+                    xl = min(xl, min(px[i], px[j]));
+                    xr = max(xr, max(px[i], px[j]));
+                } else {
+                    x = px[i] + (int16_t)floor(((double)(y - py[i]) * (px[j] - px[i]) / (py[j] - py[i])) + 0.5);
+                    xl = min(xl, x);
+                    xr = max(xr, x);
+                }
+            }
+            if (xl <= xr) _hline(xl, xr, y, c);
+        }
+    }
+    _line(x0, y0, x1, y1, c);
+    _line(x1, y1, x2, y2, c);
+    _line(x2, y2, x0, y0, c);
+}
+
+/******************************************************************************/
+/*!
+ DCR [0x90]: line, rectangle, triangle (bit 7) and circle (bit 6), fill = bit 5
+ [private]
+ */
+/******************************************************************************/
+void XGHost::_drawEngine(uint8_t dcr)
+{
+    int16_t x0 = _get16(RA8875_DLHSR0), y0 = _get16(RA8875_DLVSR0);
+    int16_t x1 = _get16(RA8875_DLHER0), y1 = _get16(RA8875_DLVER0);
+    int16_t y;
+    bool fill = dcr & 0x20;
+    uint16_t c = _fg();
+
+    stats.engineRuns++;
+    if (dcr & 0x80) {
+        if (dcr & 0x10) {                                                       // rectangle
+            if (y0 > y1) { y = y0; y0 = y1; y1 = y; }
+            if (fill) {
+                for (y = y0; y <= y1; y++) _hline(x0, x1, y, c);
+            } else {
+                _hline(x0, x1, y0, c);
+                _hline(x0, x1, y1, c);
+                _line(x0, y0, x0, y1, c);
+                _line(x1, y0, x1, y1, c);
+            }
+        } else if (dcr & 0x01) {                                                // triangle
+            _triangle(x0, y0, x1, y1, _get16(RA8875_DTPH0), _get16(RA8875_DTPV0), fill, c);
+        } else {                                                                // line
+            _line(x0, y0, x1, y1, c);
+        }
+    } else {                                                                    // circle
+        _ellipse(_get16(RA8875_DCHR0), _get16(RA8875_DCVR0), _reg[RA8875_DCRR], _reg[RA8875_DCRR], 0x0F, fill, c);
+    }
+    _reg[RA8875_DCR] &= ~0xC0;                                                  // done
+}
+
+/******************************************************************************/
+/*!
+ ELLIPSE [0xA0]: ellipse, curve (bit 4, part = bits 1-0) or rounded
+ rectangle (bit 5), fill = bit 6
+ [private]
+ */
+/******************************************************************************/
+void XGHost::_ellipseEngine(uint8_t v)
+{
+    int16_t a = _get16(RA8875_ELL_A0), b = _get16(RA8875_ELL_B0);
+    int16_t x0, y0, x1, y1, y, t;
+    bool fill = v & 0x40;
+    uint16_t c = _fg();
+
+    stats.engineRuns++;
+    if (v & 0x20) {                                                             // rounded rectangle, corners = quarter ellipses
+        x0 = _get16(RA8875_DLHSR0); y0 = _get16(RA8875_DLVSR0);
+        x1 = _get16(RA8875_DLHER0); y1 = _get16(RA8875_DLVER0);
+        if (x0 > x1) { t = x0; x0 = x1; x1 = t; }
+        if (y0 > y1) { t = y0; y0 = y1; y1 = t; }
+        _ellipse(x0 + a, y1 - b, a, b, 0x01, fill, c);
+        _ellipse(x0 + a, y0 + b, a, b, 0x02, fill, c);
+        _ellipse(x1 - a, y0 + b, a, b, 0x04, fill, c);
+        _ellipse(x1 - a, y1 - b, a, b, 0x08, fill, c);
+        if (fill) {
+            for (y = y0; y <= y1; y++) {
+                if (y < y0 + b || y > y1 - b) _hline(x0 + a, x1 - a, y, c);
+                else _hline(x0, x1, y, c);
+            }
+        } else {
+            _hline(x0 + a, x1 - a, y0, c);
+            _hline(x0 + a, x1 - a, y1, c);
+            _line(x0, y0 + b, x0, y1 - b, c);
+            _line(x1, y0 + b, x1, y1 - b, c);
+        }
+    } else {
+        _ellipse(_get16(RA8875_DEHR0), _get16(RA8875_DEVR0), a, b, (v & 0x10) ? (1 << (v & 0x03)) : 0x0F, fill, c);
+    }
+    _reg[RA8875_ELLIPSE] &= ~0x80;                                              // done
+}
+
+/******************************************************************************/
+/*!
+ MCLR [0x8E]: fill the full screen or the active window (bit 6) with the
+ background color
+ [private]
+ */
+/******************************************************************************/
+void XGHost::_memoryClear(void)
+{
+    int16_t x, y;
+    uint16_t c = _bg();
+    uint8_t l = _layer();
+    bool active = _reg[RA8875_MCLR] & RA8875_MCLR_ACTIVE;
+
+    stats.engineRuns++;
+    for (y = 0; y < height(); y++) {
+        for (x = 0; x < width(); x++) {
+            if (!active || _inWindow(x, y)) _mem[l][(y * XG_HOST_MAX_WIDTH) + x] = c;
+        }
+    }
+    _reg[RA8875_MCLR] &= ~RA8875_MCLR_START;
+}
+
+/*
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
++                                BTE                                           +
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+BECR1 [0x51]: bits 7-4 = ROP (or start bit for color expansion), bits 3-0 = operation:
+ 0 write (MCU data) with ROP         4 transparent write (MCU data)     8 color expansion (MCU data)
+ 2 move positive direction with ROP  5 transparent move                 9 color expansion with transparency
+ 3 move negative direction with ROP  A move with color expansion        B move with color expansion and transparency
+ C solid fill
+The transparent color is the foreground color. Read and pattern fill are not modelled.
+ */
+
+uint16_t XGHost::_rop(uint8_t rop, uint16_t s, uint16_t d) const
+{
+    uint16_t r;
+    switch (rop & 0x0F) {
+        case 0x0:   r = 0;              break;
+        case 0x1:   r = ~(s | d);       break;
+        case 0x2:   r = ~s & d;         break;
+        case 0x3:   r = ~s;             break;
+        case 0x4:   r = s & ~d;         break;
+        case 0x5:   r = ~d;             break;
+        case 0x6:   r = s ^ d;          break;
+        case 0x7:   r = ~(s & d);       break;
+        case 0x8:   r = s & d;          break;
+        case 0x9:   r = ~(s ^ d);       break;
+        case 0xA:   r = d;              break;
+        case 0xB:   r = ~s | d;         break;
+        case 0xC:   r = s;              break;
+        case 0xD:   r = s | ~d;         break;
+        case 0xE:   r = s | d;          break;
+        default:    r = 0xFFFF;         break;
+    }
+    return is16bpp() ? r : (r & 0xFF);
+}
+
+void XGHost::_bteStart(void)
+{
+    uint8_t op = _reg[RA8875_BECR1] & 0x0F;
+    int16_t dx = _get16(RA8875_HDBE0) & 0x3FF, dy = _get16(RA8875_VDBE0) & 0x1FF;
+    int16_t w = _get16(RA8875_BEWR0) & 0x3FF, h = _get16(RA8875_BEHR0) & 0x3FF;
+    uint8_t dl = _reg[RA8875_VDBE0 + 1] >> 7;
+    int16_t x, y;
+    uint16_t c = _fg();
+
+    stats.engineRuns++;
+    switch (op) {
+        case 0x0:
+        case 0x4:
+        case 0x8:
+        case 0x9:                                                               // data follows through MRWC
+            _bteMcu = true;
+            _bteIdx = 0;
+            _memHalf = false;
+            if (w == 0 || h == 0) _bteDone();
+            return;
+        case 0x2:
+        case 0x3:
+        case 0x5:
+        case 0xA:
+        case 0xB:
+            _bteMove(op);
+            break;
+        case 0xC:
+            for (y = dy; y < dy + h && y < height(); y++) {
+                for (x = dx; x < dx + w && x < width(); x++) _mem[dl][(y * XG_HOST_MAX_WIDTH) + x] = c;
+            }
+            break;
+    }
+    _bteDone();
+}
+
+void XGHost::_bteDone(void)
+{
+    _bteMcu = false;
+    uint8_t before = pinRead(XG_PIN_TP_IRQ);
+    _reg[RA8875_BECR0] &= ~0x80;
+    _reg[RA8875_INTC2] |= RA8875_INTCx_BTE;
+    _intUpdate(before);
+}
+
+void XGHost::_bteMove(uint8_t op)
+{
+    int16_t sx = _get16(RA8875_HSBE0) & 0x3FF, sy = _get16(RA8875_VSBE0) & 0x1FF;
+    int16_t dx = _get16(RA8875_HDBE0) & 0x3FF, dy = _get16(RA8875_VDBE0) & 0x1FF;
+    int16_t w = _get16(RA8875_BEWR0) & 0x3FF, h = _get16(RA8875_BEHR0) & 0x3FF;
+    uint8_t sl = _reg[RA8875_VSBE0 + 1] >> 7, dl = _reg[RA8875_VDBE0 + 1] >> 7;
+    uint8_t rop = _reg[RA8875_BECR1] >> 4;
+    bool linear = _reg[RA8875_BECR0] & 0x40;
+    int16_t i, j, s = (op == 0x3) ? -1 : 1;                                     // negative direction: coordinates are the bottom right corners
+    int16_t x, y;
+    uint32_t k = 0, src = (sy * XG_HOST_MAX_WIDTH) + sx;
+    uint16_t c, word = 0, fg = _fg(), bg = _bg();
+    int8_t bit = -1, bits = is16bpp() ? 16 : 8;
+
+    for (j = 0; j < h; j++) {
+        bit = -1;
+        for (i = 0; i < w; i++) {
+            x = dx + (s * i);
+            y = dy + (s * j);
+            if (op == 0xA || op == 0xB) {                                       // color expansion, source = linear words
+                if (bit < 0) {
+                    word = _mem[sl][(src + k++) % (XG_HOST_MAX_WIDTH * XG_HOST_MAX_HEIGHT)];
+                    bit = (i == 0) ? (rop & (bits - 1)) : (bits - 1);
+                }
+                c = ((word >> bit--) & 1) ? fg : bg;
+                if (op == 0xB && c == bg) continue;
+            } else {
+                if (linear) {
+                    c = _mem[sl][(src + k++) % (XG_HOST_MAX_WIDTH * XG_HOST_MAX_HEIGHT)];
+                } else {
+                    if (sx + (s * i) < 0 || sy + (s * j) < 0) continue;
+                    c = _mem[sl][((sy + (s * j)) * XG_HOST_MAX_WIDTH) + sx + (s * i)];
+                }
+                if (op == 0x5 && c == fg) continue;
+            }
+            if (x < 0 || y < 0 || x >= width() || y >= height()) continue;
+            if (op == 0x2 || op == 0x3) c = _rop(rop, c, _mem[dl][(y * XG_HOST_MAX_WIDTH) + x]);
+            _mem[dl][(y * XG_HOST_MAX_WIDTH) + x] = c;
+        }
+    }
+}
+
+/******************************************************************************/
+/*!
+ One MRWC data word during a MCU BTE: a pixel, or a byte of a color
+ expansion, each row of a color expansion starts with a new byte at the
+ start bit (ROP)
+ [private]
+ */
+/******************************************************************************/
+void XGHost::_bteMcuPixel(uint16_t data)
+{
+    int16_t dx = _get16(RA8875_HDBE0) & 0x3FF, dy = _get16(RA8875_VDBE0) & 0x1FF;
+    int16_t w = _get16(RA8875_BEWR0) & 0x3FF, h = _get16(RA8875_BEHR0) & 0x3FF;
+    uint8_t dl = _reg[RA8875_VDBE0 + 1] >> 7;
+    uint8_t rop = _reg[RA8875_BECR1] >> 4;
+    uint8_t op = _reg[RA8875_BECR1] & 0x0F;
+    int8_t bit;
+    int16_t x, y;
+    uint16_t c;
+    uint32_t p;
+
+    stats.memWrites++;
+    if (op == 0x8 || op == 0x9) {
+        bit = ((_bteIdx % w) == 0) ? (rop & 0x07) : 7;
+        for (; bit >= 0; bit--) {
+            x = dx + (_bteIdx % w);
+            y = dy + (_bteIdx / w);
+            c = ((data >> bit) & 1) ? _fg() : _bg();
+            if ((op == 0x8 || c != _bg()) && x < width() && y < height()) _mem[dl][(y * XG_HOST_MAX_WIDTH) + x] = c;
+            if ((++_bteIdx % w) == 0) break;                                    // rest of the byte is not used
+        }
+    } else {
+        x = dx + (_bteIdx % w);
+        y = dy + (_bteIdx / w);
+        _bteIdx++;
+        if (x < width() && y < height() && !(op == 0x4 && data == _fg())) {
+            p = (y * XG_HOST_MAX_WIDTH) + x;
+            _mem[dl][p] = (op == 0x0) ? _rop(rop, data, _mem[dl][p]) : data;
+        }
+    }
+    if (_bteIdx >= (uint32_t)w * h) _bteDone();
+}
+
+/*
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
++                                INSPECTION                                    +
+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ */
+
+uint16_t XGHost::pixel(uint8_t layer, int16_t x, int16_t y) const
+{
+    if (layer > 1 || x < 0 || y < 0 || x >= XG_HOST_MAX_WIDTH || y >= XG_HOST_MAX_HEIGHT) return 0;
+    return _mem[layer][(y * XG_HOST_MAX_WIDTH) + x];
+}
+
+uint32_t XGHost::_toRGB(uint16_t c) const
+{
+    uint32_t r, g, b;
+    if (is16bpp()) {
+        r = ((c >> 11) & 0x1F) * 255 / 31;
+        g = ((c >> 5) & 0x3F) * 255 / 63;
+        b = (c & 0x1F) * 255 / 31;
+    } else {
+        r = ((c >> 5) & 0x07) * 255 / 7;
+        g = ((c >> 2) & 0x07) * 255 / 7;
+        b = (c & 0x03) * 255 / 3;
+    }
+    return (r << 16) | (g << 8) | b;
+}
+
+uint32_t XGHost::rgb(uint8_t layer, int16_t x, int16_t y) const
+{
+    return _toRGB(pixel(layer, x, y));
+}
+
+/******************************************************************************/
+/*!
+ Displayed color, mixes the layers like LTPR0 [0x52] bits 2-0 in 2 layer mode
+ [private]
+ */
+/******************************************************************************/
+uint32_t XGHost::displayed(int16_t x, int16_t y) const
+{
+    uint16_t l1 = pixel(0, x, y), l2 = pixel(1, x, y);
+    uint32_t a = _toRGB(l1), b = _toRGB(l2);
+
+    if (!(_reg[RA8875_DPCR] & RA8875_DPCR_TWO_LAYERS)) return a;
+    switch (_reg[RA8875_LTPR0] & 0x07) {
+        case 1:     return b;                                                   // layer 2 only
+        case 2:     return (max(a & 0xFF0000, b & 0xFF0000)) | (max(a & 0xFF00, b & 0xFF00)) | (max(a & 0xFF, b & 0xFF));  // lighten
+        case 3:     return (l1 == _colorReg(RA8875_BGTR0)) ? b : a;             // transparent
+        case 4:     return a | b;
+        case 5:     return a & b;
+        default:    return a;                                                   // layer 1 only (floating windows are not modelled)
+    }
+}
+
+uint32_t XGHost::checksum(int8_t layer) const
+{
+    uint32_t h = 2166136261UL, v;
+    int16_t x, y;
+    for (y = 0; y < height(); y++) {
+        for (x = 0; x < width(); x++) {
+            v = (layer < 0) ? displayed(x, y) : pixel(layer, x, y);
+            h = (h ^ v) * 16777619UL;                                           // FNV-1a
+        }
+    }
+    return h;
+}
+
+bool XGHost::savePPM(const char *filename, int8_t layer) const
+{
+    FILE *f = fopen(filename, "wb");
+    int16_t x, y;
+    uint32_t c;
+
+    if (f == NULL) return false;
+    fprintf(f, "P6\n%d %d\n255\n", width(), height());
+    for (y = 0; y < height(); y++) {
+        for (x = 0; x < width(); x++) {
+            c = (layer < 0) ? displayed(x, y) : rgb(layer, x, y);
+            fputc(c >> 16, f);
+            fputc((c >> 8) & 0xFF, f);
+            fputc(c & 0xFF, f);
+        }
+    }
+    return fclose(f) == 0;
+}
+
+void XGHost::printStats(const char *title)
+{
+    printf("%s%sSPI bytes %llu, CS low %llu / high %llu, reg W %llu R %llu, status R %llu, mem W %llu R %llu, engine runs %llu, time %.3f ms\n",
+           title ? title : "", title ? ": " : "",
+           (unsigned long long)stats.bytes, (unsigned long long)stats.csFalling, (unsigned long long)stats.csRising,
+           (unsigned long long)stats.regWrites, (unsigned long long)stats.regReads, (unsigned long long)stats.statusReads,
+           (unsigned long long)stats.memWrites, (unsigned long long)stats.memReads, (unsigned long long)stats.engineRuns,
+           stats.ns / 1000000.0);
+}
+
+#endif
@@ -0,0 +1,255 @@
+/*
+ Host (PC) backend for the XGLCD library for www.x-graph.be
+ Runs XGLCD.cpp on a Linux/macOS build machine without a panel: the SPI macro's
+ of XGLCD.h are implemented against a RA8875 model (XGHost.cpp) and the few
+ Arduino core functions the library uses are provided here.
+ Copyright (c) 2019 DELCOMp bvba / UVee bvba
+ 2sd (a t) delcomp (d o t) com
+
+ License:GNU General Public License v3.0
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ BUILD (from the library folder):
+    g++ -DXG_CPU_HOST -Isrc -o xghost mytest.cpp src/XGLCD.cpp src/XGDisplayList.cpp src/host/XGHost.cpp
+
+ The model:
+ - decodes the RA8875 SPI frames (command/data write, data/status read) and keeps all registers
+ - keeps 2 layers of 800x480 video memory at 8 or 16 bpp, including memory read/write cursors,
+   read/write direction and the active window
+ - runs the line, rectangle, triangle, circle, ellipse, curve and rounded rectangle engines,
+   memory clear and the BTE (MCU write, move, transparent move, color expansion, solid fill)
+ - raises INTC2 flags and the INT pin (XG_PIN_TP_IRQ) for BTE and font writes, a routine set with
+   attachInterrupt() is called on the falling edge
+ - counts every SPI byte, CS edge, register and memory access and keeps a virtual clock: every SPI
+   byte takes the time it would take at the selected SPI speed, delay() only advances the clock
+ - saves the displayed image (or one layer) as a PPM file
+ Not modelled: CGROM/external font glyphs (text mode writes only move the font cursor), scrolling,
+ the graphic/text cursors, touch and key scan. Engines complete immediately, they are never busy.
+*/
+
+#ifndef _XGHOST_H_
+#define _XGHOST_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//                            ARDUINO CORE SUBSET                              +
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+typedef bool        boolean;
+typedef uint8_t     byte;
+typedef uint16_t    word;
+
+#define HIGH                            1
+#define LOW                             0
+#define INPUT                           0
+#define OUTPUT                          1
+#define INPUT_PULLUP                    2
+#define FALLING                         2
+#define LSBFIRST                        0
+#define MSBFIRST                        1
+#define SPI_MODE0                       0
+#define SPI_MODE1                       1
+#define SPI_MODE2                       2
+#define SPI_MODE3                       3
+#define DEC                             10
+#define HEX                             16
+#define OCT                             8
+#define BIN                             2
+
+#ifndef PI
+#define PI                              3.1415926535897932384626433832795
+#endif
+#define DEG_TO_RAD                      0.017453292519943295769236907684886
+#define RAD_TO_DEG                      57.295779513082320876798154814105
+#define min(a,b)                        ((a)<(b)?(a):(b))
+#define max(a,b)                        ((a)>(b)?(a):(b))
+#define constrain(amt,low,high)         ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+#define bitRead(value, bit)             (((value) >> (bit)) & 0x01)
+
+inline long map(long x, long in_min, long in_max, long out_min, long out_max)
+{
+    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+class Print {
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t b) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size) {
+        size_t n = 0;
+        while (size--) n += write(*buffer++);
+        return n;
+    }
+    size_t write(const char *str) { return (str == NULL) ? 0 : write((const uint8_t *)str, strlen(str)); }
+
+    size_t print(const char s[])                { return write(s); }
+    size_t print(char c)                        { return write((uint8_t)c); }
+    size_t print(int n, int base = DEC)         { return print((long)n, base); }
+    size_t print(unsigned int n, int base = DEC){ return print((unsigned long)n, base); }
+    size_t print(long n, int base = DEC)        { return (base == DEC && n < 0) ? print('-') + _printNumber(-(unsigned long)n, DEC) : _printNumber((unsigned long)n, base); }
+    size_t print(unsigned long n, int base = DEC) { return _printNumber(n, base); }
+    size_t print(double n, int digits = 2)      { char s[40]; snprintf(s, sizeof(s), "%.*f", digits, n); return write(s); }
+    size_t println(void)                        { return write("\r\n"); }
+    template <typename T> size_t println(T v)   { return print(v) + println(); }
+    template <typename T> size_t println(T v, int f) { return print(v, f) + println(); }
+
+  private:
+    size_t _printNumber(unsigned long n, int base) {
+        char s[8 * sizeof(long) + 1];
+        char *p = &s[sizeof(s) - 1];
+        if (base < 2) base = DEC;
+        *p = 0;
+        do { *--p = "0123456789ABCDEF"[n % base]; n /= base; } while (n);
+        return write(p);
+    }
+};
+
+class XGHostSerial : public Print {
+  public:
+    void begin(unsigned long baud) { (void)baud; }
+    virtual size_t write(uint8_t b) { return fputc(b, stdout) == EOF ? 0 : 1; }
+    using Print::write;
+};
+extern XGHostSerial Serial;
+
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+//                            RA8875 MODEL                                     +
+//++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#define XG_HOST_MAX_WIDTH               800
+#define XG_HOST_MAX_HEIGHT              480
+
+class XGHost {
+  public:
+    XGHost(void);
+
+    // SPI bus, used by the XGLCD.h macro's
+    void        begin(void);
+    void        setSpeed(uint32_t hz) { _speed = hz; }
+    void        csLow(void);
+    void        csHigh(void);
+    uint8_t     transfer(uint8_t b);
+    void        write16(uint16_t d) { transfer(d >> 8); transfer(d & 0xFF); }
+    void        writeBytes(const uint8_t *b, uint32_t n) { while (n--) transfer(*b++); }
+    void        writeSwapped(const uint16_t *w, uint32_t n) { while (n--) write16(*w++); }
+
+    // Board
+    void        pinWrite(uint8_t pin, uint8_t v);
+    uint8_t     pinRead(uint8_t pin);
+    void        attachIsr(uint8_t pin, void (*isr)(void));                      // only the INT pin (XG_PIN_TP_IRQ), falling edge
+    void        delayNs(uint64_t ns) { stats.ns += ns; }
+    uint64_t    nanos(void) const { return stats.ns; }
+
+    // Statistics, cleared by resetStats()
+    struct Stats {
+        uint64_t    bytes;                                                      // SPI bytes in both directions
+        uint64_t    csFalling;                                                  // CS edges
+        uint64_t    csRising;
+        uint64_t    regWrites;                                                  // register writes (except MRWC)
+        uint64_t    regReads;
+        uint64_t    statusReads;
+        uint64_t    memWrites;                                                  // pixels (or font chars) written via MRWC
+        uint64_t    memReads;                                                   // pixels read via MRWC
+        uint64_t    engineRuns;                                                 // draw engine, BTE and memory clear starts
+        uint64_t    ns;                                                         // virtual time
+    } stats;
+    void        resetStats(void) { uint64_t t = stats.ns; memset(&stats, 0, sizeof(stats)); stats.ns = t; }
+    void        printStats(const char *title = NULL);
+
+    // Inspection
+    uint8_t     reg(uint8_t r) const { return _reg[r]; }
+    uint16_t    width(void) const;
+    uint16_t    height(void) const;
+    bool        is16bpp(void) const { return (_reg[0x10] & 0x0C) != 0; }
+    uint16_t    pixel(uint8_t layer, int16_t x, int16_t y) const;               // raw memory value (RGB565 or RGB332)
+    uint32_t    rgb(uint8_t layer, int16_t x, int16_t y) const;                 // 0x00RRGGBB
+    uint32_t    displayed(int16_t x, int16_t y) const;                          // after layer mixing, 0x00RRGGBB
+    uint32_t    checksum(int8_t layer = -1) const;
+    bool        savePPM(const char *filename, int8_t layer = -1) const;         // layer -1 = displayed image
+
+  private:
+    uint8_t     _reg[256];
+    uint16_t    _mem[2][XG_HOST_MAX_WIDTH * XG_HOST_MAX_HEIGHT];
+    uint8_t     _pins[64];
+    void        (*_isr)(void);                                                  // INT pin interrupt routine
+    uint32_t    _speed;
+    bool        _cs;                                                            // CS is low
+    uint32_t    _frameIdx;                                                      // byte index in the current CS low period
+    uint8_t     _frameType;                                                     // first byte of the frame (0x00, 0x40, 0x80, 0xC0)
+    uint8_t     _curReg;
+    uint8_t     _memHi;                                                         // first byte of a 16 bit memory write
+    bool        _memHalf;
+    uint32_t    _memReadIdx;                                                    // bytes read since MRWC/read cursor was set
+    uint16_t    _memReadPix;
+    // MCU BTE (write, transparent write, color expansion) in progress
+    bool        _bteMcu;
+    uint32_t    _bteIdx;
+    int8_t      _bteBit;
+
+    void        _reset(void);
+    void        _writeReg(uint8_t r, uint8_t v);
+    uint8_t     _readReg(uint8_t r);
+    void        _memWrite(uint8_t b);
+    uint8_t     _memRead(void);
+    void        _memWritePixel(uint16_t c);
+    void        _fontWrite(uint8_t c);
+
+    uint16_t    _get16(uint8_t r) const { return _reg[r] | (_reg[r + 1] << 8); }
+    void        _set16(uint8_t r, uint16_t v) { _reg[r] = v & 0xFF; _reg[r + 1] = v >> 8; }
+    uint16_t    _fg(void) const;
+    uint16_t    _bg(void) const;
+    uint16_t    _colorReg(uint8_t r) const;
+    uint8_t     _layer(void) const;
+    bool        _inWindow(int16_t x, int16_t y) const;
+    void        _plot(int16_t x, int16_t y, uint16_t c);
+    void        _hline(int16_t x1, int16_t x2, int16_t y, uint16_t c);
+    void        _line(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t c);
+    void        _ellipse(int16_t xc, int16_t yc, int16_t a, int16_t b, uint8_t quads, bool fill, uint16_t c);
+    void        _triangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, bool fill, uint16_t c);
+    void        _drawEngine(uint8_t dcr);
+    void        _ellipseEngine(uint8_t v);
+    void        _memoryClear(void);
+    void        _bteStart(void);
+    void        _bteMove(uint8_t op);
+    void        _bteMcuPixel(uint16_t data);
+    void        _bteDone(void);
+    void        _intUpdate(uint8_t before);
+    uint16_t    _rop(uint8_t rop, uint16_t s, uint16_t d) const;
+    uint32_t    _toRGB(uint16_t c) const;
+};
+
+extern XGHost xgHost;
+
+inline unsigned long millis(void)                   { return (unsigned long)(xgHost.nanos() / 1000000ULL); }
+inline unsigned long micros(void)                   { return (unsigned long)(xgHost.nanos() / 1000ULL); }
+inline void delay(unsigned long ms)                 { xgHost.delayNs(ms * 1000000ULL); }
+inline void delayMicroseconds(unsigned int us)      { xgHost.delayNs(us * 1000ULL); }
+inline void pinMode(uint8_t pin, uint8_t mode)      { (void)pin; (void)mode; }
+inline void digitalWrite(uint8_t pin, uint8_t v)    { xgHost.pinWrite(pin, v); }
+inline int  digitalRead(uint8_t pin)                { return xgHost.pinRead(pin); }
+inline void yield(void)                             {}
+inline void attachInterrupt(uint8_t pin, void (*isr)(void), int mode) { (void)mode; xgHost.attachIsr(pin, isr); }
+inline void detachInterrupt(uint8_t pin)            { xgHost.attachIsr(pin, NULL); }
+#define digitalPinToInterrupt(p)        (p)
+inline void interrupts(void)                        {}
+inline void noInterrupts(void)                      {}
+
+#endif
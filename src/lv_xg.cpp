@@ -26,8 +26,12 @@
 XGLCD tft = XGLCD();
 
 void my_disp_flush(int32_t x1, int32_t y1, int32_t x2, int32_t y2, const lv_color_t *color_array) {
+#if defined(XG_CPU_ESP32)
+  tft.drawBitmapAsync(x1, y1, x2, y2, (uint16_t *)color_array, lv_flush_ready); // DMA in the background, lv_flush_ready() is called when done (LV_VDB_DOUBLE can be used)
+#else
   tft.drawBitmap(x1, y1, x2, y2, (uint16_t *)color_array);                    // copy 'color_array' to the specifed coordinates
   lv_flush_ready();                                                           // Tell the flushing is ready
+#endif
 }
 
 void my_disp_map(int32_t x1,int32_t y1,int32_t x2,int32_t y2, const lv_color_t* color_p) {